@@ -0,0 +1,60 @@
+/**
+ * @file bench.h
+ * @brief Shared helpers for the KORRA microbenchmarks
+ *
+ * Results are printed one per line in a machine-readable form:
+ *
+ *   bench=<name> <params> ops=<n> ns_per_op=<n> p50_ns=<n> p99_ns=<n>
+ *
+ * so release-to-release diffs can be tracked with grep and a
+ * spreadsheet rather than by anecdote.
+ */
+
+#ifndef KORRA_BENCH_H
+#define KORRA_BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+// Monotonic clock in nanoseconds
+static inline uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int bench_cmp_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Sort samples in place and return the p-th percentile (p in [0,100])
+static inline uint64_t bench_percentile(uint64_t* samples, size_t count, int p) {
+    if (count == 0) {
+        return 0;
+    }
+    qsort(samples, count, sizeof(uint64_t), bench_cmp_u64);
+    size_t index = (count - 1) * (size_t)p / 100;
+    return samples[index];
+}
+
+// Emit one result line. `params` is a space-separated key=value string
+// ("" for none); sorts the samples as a side effect.
+static inline void bench_report(const char* name, const char* params,
+                                uint64_t ops, uint64_t elapsed_ns,
+                                uint64_t* samples, size_t sample_count) {
+    uint64_t p50 = bench_percentile(samples, sample_count, 50);
+    uint64_t p99 = bench_percentile(samples, sample_count, 99);
+
+    printf("bench=%s%s%s ops=%llu ns_per_op=%llu p50_ns=%llu p99_ns=%llu\n",
+           name, params[0] ? " " : "", params,
+           (unsigned long long)ops,
+           (unsigned long long)(ops ? elapsed_ns / ops : 0),
+           (unsigned long long)p50, (unsigned long long)p99);
+    fflush(stdout);
+}
+
+#endif // KORRA_BENCH_H
@@ -0,0 +1,103 @@
+/**
+ * @file bench_ffi.c
+ * @brief FFI crossing cost with stub Rust callbacks
+ *
+ * The stubs do the minimum a real agent engine would (allocate and
+ * fill an output through c_alloc_callback), so the numbers isolate the
+ * glue layer itself: callback dispatch, the execution arena, the warm
+ * agent cache and the output copy-out.
+ */
+
+#include <string.h>
+#include "../include/rust_glue.h"
+#include "bench.h"
+
+#define CREATE_ITERS 100000
+#define EXECUTE_ITERS 100000
+#define INPUT_SIZE 1024
+
+// Stub callbacks standing in for the Rust engine
+static agent_handle_t stub_create(const char* agent_type, const char* config) {
+    (void)agent_type;
+    (void)config;
+    return malloc(1);
+}
+
+static int stub_execute(agent_handle_t handle, const void* input, size_t input_size,
+                        void** output, size_t* output_size) {
+    (void)handle;
+    *output = c_alloc_callback(input_size);
+    if (!*output) {
+        return -1;
+    }
+    memcpy(*output, input, input_size);
+    *output_size = input_size;
+    return 0;
+}
+
+static void stub_destroy(agent_handle_t handle) {
+    free(handle);
+}
+
+// create/destroy round trip; after the first pair this exercises the
+// warm agent cache rather than the stub
+static void bench_create_destroy(void) {
+    uint64_t* samples = malloc(CREATE_ITERS * sizeof(uint64_t));
+
+    uint64_t begin = bench_now_ns();
+    for (int i = 0; i < CREATE_ITERS; i++) {
+        uint64_t start = bench_now_ns();
+        agent_handle_t handle = create_agent("bench", "{}");
+        destroy_agent(handle);
+        samples[i] = bench_now_ns() - start;
+    }
+    uint64_t elapsed = bench_now_ns() - begin;
+
+    bench_report("ffi_create_destroy", "cache=warm", CREATE_ITERS, elapsed,
+                 samples, CREATE_ITERS);
+    free(samples);
+}
+
+// execute_agent round trip through the arena and output copy-out
+static void bench_execute(void) {
+    uint64_t* samples = malloc(EXECUTE_ITERS * sizeof(uint64_t));
+    char input[INPUT_SIZE];
+    memset(input, 0x42, sizeof(input));
+
+    agent_handle_t handle = create_agent("bench", "{}");
+
+    uint64_t begin = bench_now_ns();
+    for (int i = 0; i < EXECUTE_ITERS; i++) {
+        void* output = NULL;
+        size_t output_size = 0;
+
+        uint64_t start = bench_now_ns();
+        execute_agent(handle, input, sizeof(input), &output, &output_size);
+        samples[i] = bench_now_ns() - start;
+
+        free(output);
+    }
+    uint64_t elapsed = bench_now_ns() - begin;
+
+    destroy_agent(handle);
+    char params[64];
+    snprintf(params, sizeof(params), "input=%d", INPUT_SIZE);
+    bench_report("ffi_execute", params, EXECUTE_ITERS, elapsed,
+                 samples, EXECUTE_ITERS);
+    free(samples);
+}
+
+int main(void) {
+    rust_ffi_callbacks_t callbacks = {
+        stub_create, stub_execute, NULL, stub_destroy
+    };
+    if (rust_ffi_init(callbacks) != 0) {
+        return 1;
+    }
+
+    bench_create_destroy();
+    bench_execute();
+
+    agent_cache_flush();
+    return 0;
+}
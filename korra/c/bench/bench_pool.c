@@ -0,0 +1,113 @@
+/**
+ * @file bench_pool.c
+ * @brief Thread pool submit-to-execution latency and throughput
+ *
+ * Measures two things: the latency from thread_pool_submit() to the
+ * task function running (sampled per task, p50/p99), and sustained
+ * submit throughput with 1..4 concurrent producers.
+ */
+
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "../include/thread.h"
+#include "bench.h"
+
+#define LATENCY_SAMPLES 50000
+#define THROUGHPUT_TASKS 200000
+
+// Latency benchmark: each task records when it started running
+static uint64_t submit_ns[LATENCY_SAMPLES];
+static uint64_t start_ns[LATENCY_SAMPLES];
+static atomic_int latency_done;
+
+static void latency_task(void* arg) {
+    size_t i = (size_t)arg;
+    start_ns[i] = bench_now_ns();
+    atomic_fetch_add(&latency_done, 1);
+}
+
+static void bench_latency(void) {
+    uint64_t samples[LATENCY_SAMPLES];
+    uint64_t begin = bench_now_ns();
+
+    for (size_t i = 0; i < LATENCY_SAMPLES; i++) {
+        thread_task_t task;
+        memset(&task, 0, sizeof(task));
+        snprintf(task.name, sizeof(task.name), "bench-lat");
+        task.function = latency_task;
+        task.arg = (void*)i;
+
+        submit_ns[i] = bench_now_ns();
+        thread_pool_submit(task);
+    }
+
+    while (atomic_load(&latency_done) < LATENCY_SAMPLES) {
+        usleep(100);
+    }
+    uint64_t elapsed = bench_now_ns() - begin;
+
+    for (size_t i = 0; i < LATENCY_SAMPLES; i++) {
+        samples[i] = start_ns[i] - submit_ns[i];
+    }
+    bench_report("pool_submit_latency", "", LATENCY_SAMPLES, elapsed,
+                 samples, LATENCY_SAMPLES);
+}
+
+// Throughput benchmark: N producers flood the pool with no-op tasks
+static atomic_int throughput_done;
+
+static void throughput_task(void* arg) {
+    (void)arg;
+    atomic_fetch_add(&throughput_done, 1);
+}
+
+static void* producer(void* arg) {
+    int tasks = (int)(size_t)arg;
+
+    for (int i = 0; i < tasks; i++) {
+        thread_task_t task;
+        memset(&task, 0, sizeof(task));
+        snprintf(task.name, sizeof(task.name), "bench-tp");
+        task.function = throughput_task;
+        thread_pool_submit(task);
+    }
+    return NULL;
+}
+
+static void bench_throughput(int producers) {
+    pthread_t threads[8];
+    int per_producer = THROUGHPUT_TASKS / producers;
+    char params[64];
+
+    atomic_store(&throughput_done, 0);
+    uint64_t begin = bench_now_ns();
+
+    for (int i = 0; i < producers; i++) {
+        pthread_create(&threads[i], NULL, producer, (void*)(size_t)per_producer);
+    }
+    for (int i = 0; i < producers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    while (atomic_load(&throughput_done) < per_producer * producers) {
+        usleep(100);
+    }
+
+    uint64_t elapsed = bench_now_ns() - begin;
+    snprintf(params, sizeof(params), "producers=%d", producers);
+    bench_report("pool_throughput", params, (uint64_t)per_producer * producers,
+                 elapsed, NULL, 0);
+}
+
+int main(void) {
+    thread_pool_init(NULL);
+
+    bench_latency();
+    for (int producers = 1; producers <= 4; producers++) {
+        bench_throughput(producers);
+    }
+
+    thread_pool_shutdown();
+    return 0;
+}
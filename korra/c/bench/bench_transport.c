@@ -0,0 +1,172 @@
+/**
+ * @file bench_transport.c
+ * @brief Transport framing throughput and latency over loopback
+ *
+ * A socketpair stands in for a loopback TCP connection (same kernel
+ * copy path, no handshake noise). For each payload size the one-way
+ * throughput run reports msg/s and GB/s; the ping-pong run reports
+ * round-trip p50/p99 for the sizes where per-message latency matters.
+ */
+
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "../include/transport.h"
+#include "bench.h"
+
+// Payload sizes swept, 4B control messages up to 16MB state payloads
+static const size_t payload_sizes[] = {
+    4, 64, 1024, 65536, 1048576, 16777216
+};
+#define NUM_SIZES (sizeof(payload_sizes) / sizeof(payload_sizes[0]))
+
+// Scale message counts down as payloads grow so runs stay short
+static int messages_for(size_t size) {
+    if (size <= 1024) {
+        return 100000;
+    }
+    if (size <= 65536) {
+        return 10000;
+    }
+    if (size <= 1048576) {
+        return 1000;
+    }
+    return 50;
+}
+
+typedef struct {
+    int fd;
+    int count;
+} drain_arg_t;
+
+// Receiver side of the throughput run: consume and free every message
+static void* drain_worker(void* arg) {
+    drain_arg_t* drain = arg;
+
+    for (int i = 0; i < drain->count; i++) {
+        transport_message_t message;
+        if (transport_receive_fd(drain->fd, &message) != 0) {
+            break;
+        }
+        transport_message_free(&message);
+    }
+    return NULL;
+}
+
+static void bench_throughput(int send_fd, int recv_fd, size_t size, void* payload) {
+    int count = messages_for(size);
+    char params[96];
+
+    transport_message_t message;
+    memset(&message, 0, sizeof(message));
+    message.msg_type = MSG_JOB_SUBMIT;
+    message.payload = payload;
+    message.payload_size = (uint32_t)size;
+
+    drain_arg_t drain = { recv_fd, count };
+    pthread_t receiver;
+    pthread_create(&receiver, NULL, drain_worker, &drain);
+
+    uint64_t begin = bench_now_ns();
+    for (int i = 0; i < count; i++) {
+        transport_send_fd(send_fd, &message);
+    }
+    pthread_join(receiver, NULL);
+    uint64_t elapsed = bench_now_ns() - begin;
+
+    double seconds = (double)elapsed / 1e9;
+    double gb_per_s = (double)size * count / seconds / 1e9;
+    snprintf(params, sizeof(params), "payload=%zu msg_per_s=%.0f gb_per_s=%.3f",
+             size, count / seconds, gb_per_s);
+    bench_report("transport_throughput", params, count, elapsed, NULL, 0);
+}
+
+typedef struct {
+    int fd;
+    int count;
+} echo_arg_t;
+
+// Receiver side of the ping-pong run: echo every message back
+static void* echo_worker(void* arg) {
+    echo_arg_t* echo = arg;
+
+    for (int i = 0; i < echo->count; i++) {
+        transport_message_t message;
+        if (transport_receive_fd(echo->fd, &message) != 0) {
+            break;
+        }
+        transport_send_fd(echo->fd, &message);
+        transport_message_free(&message);
+    }
+    return NULL;
+}
+
+static void bench_pingpong(int fd, int peer_fd, size_t size, void* payload) {
+    int count = messages_for(size) / 10;
+    uint64_t* samples = malloc(count * sizeof(uint64_t));
+    char params[64];
+
+    transport_message_t message;
+    memset(&message, 0, sizeof(message));
+    message.msg_type = MSG_HEARTBEAT;
+    message.payload = payload;
+    message.payload_size = (uint32_t)size;
+
+    echo_arg_t echo = { peer_fd, count };
+    pthread_t echoer;
+    pthread_create(&echoer, NULL, echo_worker, &echo);
+
+    uint64_t begin = bench_now_ns();
+    for (int i = 0; i < count; i++) {
+        uint64_t start = bench_now_ns();
+        transport_send_fd(fd, &message);
+
+        transport_message_t reply;
+        if (transport_receive_fd(fd, &reply) != 0) {
+            break;
+        }
+        transport_message_free(&reply);
+        samples[i] = bench_now_ns() - start;
+    }
+    pthread_join(echoer, NULL);
+    uint64_t elapsed = bench_now_ns() - begin;
+
+    snprintf(params, sizeof(params), "payload=%zu", size);
+    bench_report("transport_roundtrip", params, count, elapsed, samples, count);
+    free(samples);
+}
+
+int main(void) {
+    void* payload = malloc(payload_sizes[NUM_SIZES - 1]);
+    if (!payload) {
+        return 1;
+    }
+    memset(payload, 0x5a, payload_sizes[NUM_SIZES - 1]);
+
+    for (size_t s = 0; s < NUM_SIZES; s++) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            perror("socketpair");
+            return 1;
+        }
+        bench_throughput(fds[0], fds[1], payload_sizes[s], payload);
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    // Round-trip latency only matters for control-plane sized payloads
+    for (size_t s = 0; s < NUM_SIZES && payload_sizes[s] <= 65536; s++) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            perror("socketpair");
+            return 1;
+        }
+        bench_pingpong(fds[0], fds[1], payload_sizes[s], payload);
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    free(payload);
+    return 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file arena.c
+ * @brief Region allocator for short-lived, bursty allocations
+ *
+ * A bump-pointer allocator over a chain of blocks. An allocation is a
+ * pointer increment; freeing is a single reset of the whole region, so
+ * workloads that make hundreds of small allocations per operation (an
+ * agent execution, a message parse) pay two libc calls total instead
+ * of two per allocation, and the heap never fragments from them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../include/arena.h"
+#define KORRA_LOG_MODULE KORRA_MODULE_CORE
+#include "../include/debug.h"
+
+// All allocations are aligned to this
+#define ARENA_ALIGNMENT 16
+
+// One block in the chain; data follows the header
+typedef struct arena_block {
+    struct arena_block* next;
+    size_t capacity;
+    size_t used;
+} arena_block_t;
+
+struct korra_arena {
+    arena_block_t* current;     // block being bumped
+    arena_block_t* first;       // kept across resets
+    size_t block_size;          // default size for new blocks
+};
+
+// Allocate and link a fresh block able to hold at least `size` bytes
+static arena_block_t* block_create(size_t size) {
+    arena_block_t* block = malloc(sizeof(arena_block_t) + size);
+    if (!block) {
+        ERROR_LOG("Failed to allocate %zu byte arena block", size);
+        return NULL;
+    }
+    block->next = NULL;
+    block->capacity = size;
+    block->used = 0;
+    return block;
+}
+
+korra_arena_t* korra_arena_create(size_t initial_size) {
+    korra_arena_t* arena = malloc(sizeof(korra_arena_t));
+    if (!arena) {
+        ERROR_LOG("Failed to allocate arena");
+        return NULL;
+    }
+
+    arena->first = block_create(initial_size);
+    if (!arena->first) {
+        free(arena);
+        return NULL;
+    }
+    arena->current = arena->first;
+    arena->block_size = initial_size;
+    return arena;
+}
+
+void* korra_arena_alloc(korra_arena_t* arena, size_t size) {
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+
+    arena_block_t* block = arena->current;
+    if (block->used + size > block->capacity) {
+        // Chain a new block, sized up for oversized requests
+        size_t block_size = size > arena->block_size ? size : arena->block_size;
+        arena_block_t* fresh = block_create(block_size);
+        if (!fresh) {
+            return NULL;
+        }
+        fresh->next = block->next;
+        block->next = fresh;
+        arena->current = fresh;
+        block = fresh;
+    }
+
+    void* ptr = (char*)(block + 1) + block->used;
+    block->used += size;
+    return ptr;
+}
+
+bool korra_arena_contains(const korra_arena_t* arena, const void* ptr) {
+    for (const arena_block_t* block = arena->first; block; block = block->next) {
+        const char* data = (const char*)(block + 1);
+        if ((const char*)ptr >= data && (const char*)ptr < data + block->capacity) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void korra_arena_reset(korra_arena_t* arena) {
+    // Keep the first block warm, drop the overflow chain
+    arena_block_t* block = arena->first->next;
+    while (block) {
+        arena_block_t* next = block->next;
+        free(block);
+        block = next;
+    }
+
+    arena->first->next = NULL;
+    arena->first->used = 0;
+    arena->current = arena->first;
+}
+
+void korra_arena_destroy(korra_arena_t* arena) {
+    if (!arena) {
+        return;
+    }
+
+    arena_block_t* block = arena->first;
+    while (block) {
+        arena_block_t* next = block->next;
+        free(block);
+        block = next;
+    }
+    free(arena);
+}
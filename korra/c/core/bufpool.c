@@ -0,0 +1,182 @@
+/**
+ * @file bufpool.c
+ * @brief Size-classed, reference-counted buffer pool for KORRA
+ *
+ * Buffers live in four size classes. Frees land on a small per-thread
+ * cache first, so the receive-path hot loop (alloc on the transport
+ * thread, release on a pool worker) usually never touches a lock; the
+ * shared per-class freelist behind a mutex is only the overflow path.
+ * Oversized requests fall back to the heap but carry the same handle,
+ * so callers never need to care where a buffer came from.
+ *
+ * Recycling is NUMA-aware: each buffer remembers the node it was
+ * first allocated on (first touch puts its pages there) and the
+ * shared freelists are kept per node, so a buffer freed by a worker
+ * on the other socket migrates back to its home node's list instead
+ * of poisoning that worker's cache with remote memory. A thread whose
+ * local node has nothing free mallocs fresh - local - pages rather
+ * than recycling remote ones.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "../include/bufpool.h"
+#include "../include/topology.h"
+#define KORRA_LOG_MODULE KORRA_MODULE_CORE
+#include "../include/debug.h"
+
+// Size classes; requests above the largest go straight to the heap
+static const size_t class_sizes[] = { 256, 4096, 65536, 1048576 };
+#define NUM_SIZE_CLASSES (sizeof(class_sizes) / sizeof(class_sizes[0]))
+
+// Per-thread cache depth per class
+#define TLS_CACHE_DEPTH 32
+
+// Marks a heap-backed buffer outside any size class
+#define SIZE_CLASS_HEAP (-1)
+
+// NUMA nodes the freelists distinguish; larger boxes fold into the
+// last slot
+#define MAX_POOL_NODES 8
+
+// Buffer header; data follows immediately after
+struct korra_buf {
+    atomic_int refcount;
+    int size_class;
+    int node;                   // home NUMA node, set at first allocation
+    size_t capacity;
+    struct korra_buf* next;     // freelist link, only valid when free
+};
+
+// Shared overflow freelists, one per node per class
+typedef struct {
+    korra_buf_t* head;
+    pthread_mutex_t mutex;
+} shared_freelist_t;
+
+static shared_freelist_t shared_lists[MAX_POOL_NODES][NUM_SIZE_CLASSES];
+static pthread_once_t lists_once = PTHREAD_ONCE_INIT;
+
+static void lists_init(void) {
+    for (int n = 0; n < MAX_POOL_NODES; n++) {
+        for (size_t c = 0; c < NUM_SIZE_CLASSES; c++) {
+            pthread_mutex_init(&shared_lists[n][c].mutex, NULL);
+        }
+    }
+}
+
+// Clamp a topology node index into the freelist range
+static int pool_node(int node) {
+    if (node < 0) {
+        return 0;
+    }
+    return node < MAX_POOL_NODES ? node : MAX_POOL_NODES - 1;
+}
+
+// Per-thread caches; long-lived worker threads keep these warm
+static __thread korra_buf_t* tls_cache[NUM_SIZE_CLASSES];
+static __thread int tls_cache_depth[NUM_SIZE_CLASSES];
+
+// Map a requested size to its class, or SIZE_CLASS_HEAP
+static int size_to_class(size_t size) {
+    for (size_t i = 0; i < NUM_SIZE_CLASSES; i++) {
+        if (size <= class_sizes[i]) {
+            return (int)i;
+        }
+    }
+    return SIZE_CLASS_HEAP;
+}
+
+korra_buf_t* korra_buf_alloc(size_t size) {
+    int size_class = size_to_class(size);
+    korra_buf_t* buf = NULL;
+
+    if (size_class != SIZE_CLASS_HEAP) {
+        // Fast path: per-thread cache, which only ever holds buffers
+        // homed on this thread's node
+        if (tls_cache[size_class]) {
+            buf = tls_cache[size_class];
+            tls_cache[size_class] = buf->next;
+            tls_cache_depth[size_class]--;
+        } else {
+            // Overflow path: this node's shared freelist. Other
+            // nodes' lists are never raided - a fresh local malloc
+            // beats recycling remote memory.
+            pthread_once(&lists_once, lists_init);
+            shared_freelist_t* list =
+                &shared_lists[pool_node(korra_topology_current_node())][size_class];
+            pthread_mutex_lock(&list->mutex);
+            if (list->head) {
+                buf = list->head;
+                list->head = buf->next;
+            }
+            pthread_mutex_unlock(&list->mutex);
+        }
+    }
+
+    if (!buf) {
+        size_t capacity = (size_class != SIZE_CLASS_HEAP) ? class_sizes[size_class] : size;
+        buf = malloc(sizeof(korra_buf_t) + capacity);
+        if (!buf) {
+            ERROR_LOG("Failed to allocate %zu byte buffer", size);
+            return NULL;
+        }
+        buf->size_class = size_class;
+        buf->capacity = capacity;
+        // First touch happens on this thread, so the pages land here
+        buf->node = pool_node(korra_topology_current_node());
+    }
+
+    atomic_store_explicit(&buf->refcount, 1, memory_order_relaxed);
+    buf->next = NULL;
+    return buf;
+}
+
+void* korra_buf_data(korra_buf_t* buf) {
+    return (void*)(buf + 1);
+}
+
+size_t korra_buf_capacity(const korra_buf_t* buf) {
+    return buf->capacity;
+}
+
+void korra_buf_ref(korra_buf_t* buf) {
+    atomic_fetch_add_explicit(&buf->refcount, 1, memory_order_relaxed);
+}
+
+void korra_buf_release(korra_buf_t* buf) {
+    if (!buf) {
+        return;
+    }
+
+    if (atomic_fetch_sub_explicit(&buf->refcount, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    // Last reference dropped: recycle or free
+    if (buf->size_class == SIZE_CLASS_HEAP) {
+        free(buf);
+        return;
+    }
+
+    // Only cache buffers homed on this thread's node; remote buffers
+    // go straight back to their home node's shared list so the next
+    // allocation there reuses local memory
+    if (buf->node == pool_node(korra_topology_current_node()) &&
+        tls_cache_depth[buf->size_class] < TLS_CACHE_DEPTH) {
+        buf->next = tls_cache[buf->size_class];
+        tls_cache[buf->size_class] = buf;
+        tls_cache_depth[buf->size_class]++;
+        return;
+    }
+
+    pthread_once(&lists_once, lists_init);
+    shared_freelist_t* list = &shared_lists[buf->node][buf->size_class];
+    pthread_mutex_lock(&list->mutex);
+    buf->next = list->head;
+    list->head = buf;
+    pthread_mutex_unlock(&list->mutex);
+}
@@ -0,0 +1,235 @@
+/**
+ * @file compress.c
+ * @brief LZ4-style block compression for KORRA payloads
+ *
+ * Greedy LZ77 over a 4-byte hash table with 16-bit match offsets,
+ * encoded in the LZ4 token layout: a byte with literal-length and
+ * match-length nibbles, 255-chunked length extensions, raw literals,
+ * and a little-endian offset. No external dependency, no allocation —
+ * the hash table lives on the stack — and decompression is a straight
+ * byte copier, so the decode side runs near memory bandwidth.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "../include/compress.h"
+
+// Hash table of 4-byte sequence positions (stack-allocated per call)
+#define HASH_BITS 12
+#define HASH_SIZE (1 << HASH_BITS)
+
+// Matches must start at least this many bytes before the input end so
+// the length-extension loops never read past it
+#define TAIL_LITERALS 12
+
+// Minimum match length the format can express
+#define MIN_MATCH 4
+
+// Maximum match offset (16-bit wire field)
+#define MAX_OFFSET 65535
+
+static uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t hash4(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Emit a length in 255-byte chunks (the part above the token nibble)
+static long emit_length(uint8_t* dst, size_t dst_capacity, size_t op, size_t length) {
+    while (length >= 255) {
+        if (op >= dst_capacity) {
+            return -1;
+        }
+        dst[op++] = 255;
+        length -= 255;
+    }
+    if (op >= dst_capacity) {
+        return -1;
+    }
+    dst[op++] = (uint8_t)length;
+    return (long)op;
+}
+
+size_t korra_compress_bound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+long korra_compress(const void* src_data, size_t src_size, void* dst_data, size_t dst_capacity) {
+    const uint8_t* src = src_data;
+    uint8_t* dst = dst_data;
+    uint32_t table[HASH_SIZE] = { 0 };   // position + 1, 0 = empty
+
+    size_t ip = 0;      // input cursor
+    size_t anchor = 0;  // start of pending literals
+    size_t op = 0;      // output cursor
+
+    if (src_size > TAIL_LITERALS) {
+        size_t match_limit = src_size - TAIL_LITERALS;
+
+        while (ip < match_limit) {
+            uint32_t sequence = read32(src + ip);
+            uint32_t h = hash4(sequence);
+            size_t candidate = table[h] ? (size_t)(table[h] - 1) : SIZE_MAX;
+            table[h] = (uint32_t)(ip + 1);
+
+            if (candidate == SIZE_MAX || ip - candidate > MAX_OFFSET ||
+                read32(src + candidate) != sequence) {
+                ip++;
+                continue;
+            }
+
+            // Extend the match as far as the tail rule allows
+            size_t match_len = MIN_MATCH;
+            while (ip + match_len < match_limit + (TAIL_LITERALS - 5) &&
+                   src[candidate + match_len] == src[ip + match_len]) {
+                match_len++;
+            }
+
+            // Token: literal-length nibble, match-length nibble
+            size_t literal_len = ip - anchor;
+            size_t token_pos = op++;
+            if (op > dst_capacity) {
+                return -1;
+            }
+
+            uint8_t token = 0;
+            if (literal_len >= 15) {
+                token |= 0xF0;
+                long next = emit_length(dst, dst_capacity, op, literal_len - 15);
+                if (next < 0) {
+                    return -1;
+                }
+                op = (size_t)next;
+            } else {
+                token |= (uint8_t)(literal_len << 4);
+            }
+
+            if (op + literal_len + 2 > dst_capacity) {
+                return -1;
+            }
+            memcpy(dst + op, src + anchor, literal_len);
+            op += literal_len;
+
+            // Offset, little-endian
+            size_t offset = ip - candidate;
+            dst[op++] = (uint8_t)(offset & 0xFF);
+            dst[op++] = (uint8_t)(offset >> 8);
+
+            if (match_len - MIN_MATCH >= 15) {
+                token |= 0x0F;
+                long next = emit_length(dst, dst_capacity, op, match_len - MIN_MATCH - 15);
+                if (next < 0) {
+                    return -1;
+                }
+                op = (size_t)next;
+            } else {
+                token |= (uint8_t)(match_len - MIN_MATCH);
+            }
+
+            dst[token_pos] = token;
+            ip += match_len;
+            anchor = ip;
+        }
+    }
+
+    // Trailing literals as a final match-less token
+    size_t literal_len = src_size - anchor;
+    size_t token_pos = op++;
+    if (op > dst_capacity) {
+        return -1;
+    }
+
+    if (literal_len >= 15) {
+        dst[token_pos] = 0xF0;
+        long next = emit_length(dst, dst_capacity, op, literal_len - 15);
+        if (next < 0) {
+            return -1;
+        }
+        op = (size_t)next;
+    } else {
+        dst[token_pos] = (uint8_t)(literal_len << 4);
+    }
+
+    if (op + literal_len > dst_capacity) {
+        return -1;
+    }
+    memcpy(dst + op, src + anchor, literal_len);
+    op += literal_len;
+
+    return (long)op;
+}
+
+long korra_decompress(const void* src_data, size_t src_size, void* dst_data, size_t dst_capacity) {
+    const uint8_t* src = src_data;
+    uint8_t* dst = dst_data;
+
+    size_t ip = 0;
+    size_t op = 0;
+
+    while (ip < src_size) {
+        uint8_t token = src[ip++];
+
+        // Literal run
+        size_t literal_len = token >> 4;
+        if (literal_len == 15) {
+            uint8_t extra;
+            do {
+                if (ip >= src_size) {
+                    return -1;
+                }
+                extra = src[ip++];
+                literal_len += extra;
+            } while (extra == 255);
+        }
+
+        if (ip + literal_len > src_size || op + literal_len > dst_capacity) {
+            return -1;
+        }
+        memcpy(dst + op, src + ip, literal_len);
+        ip += literal_len;
+        op += literal_len;
+
+        // The final token carries no match
+        if (ip >= src_size) {
+            break;
+        }
+
+        if (ip + 2 > src_size) {
+            return -1;
+        }
+        size_t offset = (size_t)src[ip] | ((size_t)src[ip + 1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op) {
+            return -1;
+        }
+
+        size_t match_len = (token & 0x0F) + MIN_MATCH;
+        if ((token & 0x0F) == 15) {
+            uint8_t extra;
+            do {
+                if (ip >= src_size) {
+                    return -1;
+                }
+                extra = src[ip++];
+                match_len += extra;
+            } while (extra == 255);
+        }
+
+        if (op + match_len > dst_capacity) {
+            return -1;
+        }
+
+        // Byte-wise copy: matches may overlap their own output
+        const uint8_t* match = dst + op - offset;
+        for (size_t i = 0; i < match_len; i++) {
+            dst[op + i] = match[i];
+        }
+        op += match_len;
+    }
+
+    return (long)op;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file crc32c.c
+ * @brief Hardware-accelerated CRC32C (Castagnoli) for payload integrity
+ *
+ * CRC32C was chosen over CRC32 because both x86 (SSE4.2) and ARMv8
+ * ship instructions for it: checksumming then runs at close to memory
+ * bandwidth instead of costing a core at multi-GB/s transfer rates.
+ * The implementation is picked once at first use - hardware when the
+ * CPU advertises it, a table fallback otherwise - through a function
+ * pointer, so callers never branch on CPU features.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "../include/crc32c.h"
+#define KORRA_LOG_MODULE KORRA_MODULE_CORE
+#include "../include/debug.h"
+
+typedef uint32_t (*crc32c_fn)(uint32_t crc, const void* data, size_t size);
+
+// ---- Table fallback (byte-wise, reflected polynomial 0x82F63B78) ----
+
+static uint32_t crc_table[256];
+
+static void table_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ ((crc & 1) ? 0x82F63B78u : 0);
+        }
+        crc_table[i] = crc;
+    }
+}
+
+static uint32_t crc32c_table(uint32_t crc, const void* data, size_t size) {
+    const uint8_t* bytes = data;
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = (crc >> 8) ^ crc_table[(crc ^ bytes[i]) & 0xFF];
+    }
+    return ~crc;
+}
+
+// ---- Hardware paths ----
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_hw(uint32_t crc, const void* data, size_t size) {
+    const uint8_t* bytes = data;
+
+    crc = ~crc;
+#if defined(__x86_64__)
+    while (size >= 8) {
+        uint64_t chunk;
+        memcpy(&chunk, bytes, 8);
+        crc = (uint32_t)__builtin_ia32_crc32di(crc, chunk);
+        bytes += 8;
+        size -= 8;
+    }
+#endif
+    while (size >= 4) {
+        uint32_t chunk;
+        memcpy(&chunk, bytes, 4);
+        crc = __builtin_ia32_crc32si(crc, chunk);
+        bytes += 4;
+        size -= 4;
+    }
+    while (size > 0) {
+        crc = __builtin_ia32_crc32qi(crc, *bytes);
+        bytes++;
+        size--;
+    }
+    return ~crc;
+}
+
+static int hw_available(void) {
+    unsigned int eax, ebx, ecx = 0, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return 0;
+    }
+    return (ecx & (1u << 20)) != 0;    // SSE4.2
+}
+
+#elif defined(__aarch64__)
+#include <sys/auxv.h>
+
+#ifndef HWCAP_CRC32
+#define HWCAP_CRC32 (1 << 7)
+#endif
+
+__attribute__((target("+crc")))
+static uint32_t crc32c_hw(uint32_t crc, const void* data, size_t size) {
+    const uint8_t* bytes = data;
+
+    crc = ~crc;
+    while (size >= 8) {
+        uint64_t chunk;
+        memcpy(&chunk, bytes, 8);
+        crc = __builtin_aarch64_crc32cx(crc, chunk);
+        bytes += 8;
+        size -= 8;
+    }
+    while (size > 0) {
+        crc = __builtin_aarch64_crc32cb(crc, *bytes);
+        bytes++;
+        size--;
+    }
+    return ~crc;
+}
+
+static int hw_available(void) {
+    return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+}
+
+#else
+
+static int hw_available(void) {
+    return 0;
+}
+
+#define crc32c_hw crc32c_table
+
+#endif
+
+// ---- Dispatch ----
+
+static crc32c_fn crc_impl;
+
+static uint32_t crc32c_pick(uint32_t crc, const void* data, size_t size) {
+    if (hw_available()) {
+        crc_impl = crc32c_hw;
+        DEBUG_LOG("CRC32C using hardware instructions");
+    } else {
+        table_init();
+        crc_impl = crc32c_table;
+        DEBUG_LOG("CRC32C using table fallback");
+    }
+    return crc_impl(crc, data, size);
+}
+
+static crc32c_fn crc_impl = crc32c_pick;
+
+uint32_t korra_crc32c_update(uint32_t crc, const void* data, size_t size) {
+    return crc_impl(crc, data, size);
+}
+
+uint32_t korra_crc32c(const void* data, size_t size) {
+    return crc_impl(0, data, size);
+}
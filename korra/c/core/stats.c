@@ -0,0 +1,241 @@
+/**
+ * @file stats.c
+ * @brief Hot-path counters and latency histograms for KORRA
+ *
+ * Every thread that records an event gets its own cache-line-aligned
+ * stats block, found through TLS and registered in a global table (the
+ * same shape as the async logger's ring registry). An event is a
+ * relaxed atomic add on memory only the owning thread writes, so the
+ * cost is a few ns and there is no sharing between threads. Snapshots
+ * walk the table and sum the blocks without taking any lock, so
+ * reporting never stalls the hot paths it is measuring.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <time.h>
+#include "../include/stats.h"
+#define KORRA_LOG_MODULE KORRA_MODULE_CORE
+#include "../include/debug.h"
+
+// Maximum registered threads
+#define MAX_STATS_THREADS 128
+
+// Cache line size used to keep blocks from sharing lines
+#define CACHE_LINE_SIZE 64
+
+// Per-thread task-name slot. Only the owning thread writes the name;
+// `used` is set with release order after the name is in place so a
+// concurrent snapshot never reads a half-written name.
+typedef struct {
+    atomic_bool used;
+    char name[64];
+    atomic_uint_fast64_t count;
+    atomic_uint_fast64_t total_us;
+} task_slot_t;
+
+// One thread's stats block. Writers use relaxed adds; snapshot readers
+// sum with relaxed loads.
+typedef struct {
+    atomic_uint_fast64_t counters[KORRA_CTR_COUNT];
+    atomic_uint_fast64_t histograms[KORRA_HIST_COUNT][KORRA_STATS_BUCKETS];
+    atomic_uint_fast64_t sent_by_type[KORRA_STATS_MSG_TYPES];
+    atomic_uint_fast64_t received_by_type[KORRA_STATS_MSG_TYPES];
+    task_slot_t tasks[KORRA_STATS_TASK_NAMES];
+} __attribute__((aligned(CACHE_LINE_SIZE))) stats_block_t;
+
+// Block registry
+static stats_block_t* blocks[MAX_STATS_THREADS];
+static atomic_int num_blocks;
+
+// Each thread finds its block through TLS
+static __thread stats_block_t* tls_block;
+
+// Get or register the calling thread's block
+static stats_block_t* get_block(void) {
+    if (tls_block) {
+        return tls_block;
+    }
+
+    int slot = atomic_fetch_add_explicit(&num_blocks, 1, memory_order_relaxed);
+    if (slot >= MAX_STATS_THREADS) {
+        atomic_fetch_sub_explicit(&num_blocks, 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    stats_block_t* block = aligned_alloc(CACHE_LINE_SIZE, sizeof(stats_block_t));
+    if (!block) {
+        atomic_fetch_sub_explicit(&num_blocks, 1, memory_order_relaxed);
+        return NULL;
+    }
+    memset(block, 0, sizeof(stats_block_t));
+
+    blocks[slot] = block;
+    tls_block = block;
+    return block;
+}
+
+void korra_stats_count(korra_counter_t counter, uint64_t delta) {
+    stats_block_t* block = get_block();
+    if (block) {
+        atomic_fetch_add_explicit(&block->counters[counter], delta, memory_order_relaxed);
+    }
+}
+
+// Map a microsecond sample to its power-of-two bucket
+static int bucket_for(uint64_t us) {
+    if (us == 0) {
+        return 0;
+    }
+    int bucket = 64 - __builtin_clzll(us);
+    return bucket < KORRA_STATS_BUCKETS ? bucket : KORRA_STATS_BUCKETS - 1;
+}
+
+void korra_stats_record(korra_histogram_t histogram, uint64_t us) {
+    stats_block_t* block = get_block();
+    if (block) {
+        atomic_fetch_add_explicit(&block->histograms[histogram][bucket_for(us)], 1,
+                                  memory_order_relaxed);
+    }
+}
+
+void korra_stats_message_sent(uint8_t msg_type, size_t bytes) {
+    stats_block_t* block = get_block();
+    if (block) {
+        atomic_fetch_add_explicit(&block->counters[KORRA_CTR_MSGS_SENT], 1,
+                                  memory_order_relaxed);
+        atomic_fetch_add_explicit(&block->counters[KORRA_CTR_BYTES_SENT], bytes,
+                                  memory_order_relaxed);
+        atomic_fetch_add_explicit(&block->sent_by_type[msg_type], 1, memory_order_relaxed);
+    }
+}
+
+void korra_stats_message_received(uint8_t msg_type, size_t bytes) {
+    stats_block_t* block = get_block();
+    if (block) {
+        atomic_fetch_add_explicit(&block->counters[KORRA_CTR_MSGS_RECEIVED], 1,
+                                  memory_order_relaxed);
+        atomic_fetch_add_explicit(&block->counters[KORRA_CTR_BYTES_RECEIVED], bytes,
+                                  memory_order_relaxed);
+        atomic_fetch_add_explicit(&block->received_by_type[msg_type], 1, memory_order_relaxed);
+    }
+}
+
+// Cheap string hash for task-name slots (FNV-1a)
+static uint32_t name_hash(const char* name) {
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash = (hash ^ (uint8_t)*name++) * 16777619u;
+    }
+    return hash;
+}
+
+void korra_stats_task_run(const char* name, uint64_t run_us) {
+    stats_block_t* block = get_block();
+    if (!block) {
+        return;
+    }
+
+    // Linear-probe from the name's hash; only this thread writes its
+    // block, so claiming a slot needs no CAS
+    uint32_t start = name_hash(name) % KORRA_STATS_TASK_NAMES;
+    task_slot_t* slot = NULL;
+
+    for (int i = 0; i < KORRA_STATS_TASK_NAMES; i++) {
+        task_slot_t* candidate = &block->tasks[(start + i) % KORRA_STATS_TASK_NAMES];
+
+        if (!atomic_load_explicit(&candidate->used, memory_order_relaxed)) {
+            snprintf(candidate->name, sizeof(candidate->name), "%s", name);
+            atomic_store_explicit(&candidate->used, true, memory_order_release);
+            slot = candidate;
+            break;
+        }
+        if (strcmp(candidate->name, name) == 0) {
+            slot = candidate;
+            break;
+        }
+    }
+
+    if (!slot) {
+        // Table full: fold the sample into the catch-all slot at the
+        // hash position so it is counted somewhere
+        slot = &block->tasks[start];
+    }
+
+    atomic_fetch_add_explicit(&slot->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&slot->total_us, run_us, memory_order_relaxed);
+}
+
+uint64_t korra_stats_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+// Find or claim the snapshot aggregate for a task name
+static korra_task_stat_t* snapshot_task_for(korra_stats_snapshot_t* out, const char* name) {
+    for (int i = 0; i < out->num_tasks; i++) {
+        if (strcmp(out->tasks[i].name, name) == 0) {
+            return &out->tasks[i];
+        }
+    }
+    if (out->num_tasks >= KORRA_STATS_TASK_NAMES) {
+        return NULL;
+    }
+
+    korra_task_stat_t* stat = &out->tasks[out->num_tasks++];
+    snprintf(stat->name, sizeof(stat->name), "%s", name);
+    stat->count = 0;
+    stat->total_us = 0;
+    return stat;
+}
+
+void korra_stats_snapshot(korra_stats_snapshot_t* out) {
+    memset(out, 0, sizeof(korra_stats_snapshot_t));
+
+    int count = atomic_load_explicit(&num_blocks, memory_order_acquire);
+    for (int b = 0; b < count; b++) {
+        stats_block_t* block = blocks[b];
+        if (!block) {
+            continue;
+        }
+
+        for (int i = 0; i < KORRA_CTR_COUNT; i++) {
+            out->counters[i] += atomic_load_explicit(&block->counters[i],
+                                                     memory_order_relaxed);
+        }
+        for (int h = 0; h < KORRA_HIST_COUNT; h++) {
+            for (int i = 0; i < KORRA_STATS_BUCKETS; i++) {
+                out->histograms[h][i] += atomic_load_explicit(&block->histograms[h][i],
+                                                              memory_order_relaxed);
+            }
+        }
+        for (int i = 0; i < KORRA_STATS_MSG_TYPES; i++) {
+            out->sent_by_type[i] += atomic_load_explicit(&block->sent_by_type[i],
+                                                         memory_order_relaxed);
+            out->received_by_type[i] += atomic_load_explicit(&block->received_by_type[i],
+                                                             memory_order_relaxed);
+        }
+
+        for (int i = 0; i < KORRA_STATS_TASK_NAMES; i++) {
+            task_slot_t* slot = &block->tasks[i];
+            if (!atomic_load_explicit(&slot->used, memory_order_acquire)) {
+                continue;
+            }
+
+            korra_task_stat_t* stat = snapshot_task_for(out, slot->name);
+            if (stat) {
+                stat->count += atomic_load_explicit(&slot->count, memory_order_relaxed);
+                stat->total_us += atomic_load_explicit(&slot->total_us, memory_order_relaxed);
+            }
+        }
+    }
+}
+
+uint64_t korra_stats_bucket_floor_us(int bucket) {
+    return bucket <= 0 ? 0 : 1ull << (bucket - 1);
+}
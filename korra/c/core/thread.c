@@ -1,157 +1,1088 @@
 /**
  * @file thread.c
  * @brief Event loop and thread pool engine for KORRA
- * 
+ *
  * This module handles the core threading and event loop mechanisms
  * for the KORRA system.
+ *
+ * Each worker owns a lock-free bounded MPMC ring (sequence-numbered
+ * cells, CAS on head/tail) and thread_pool_submit() round-robins tasks
+ * across the workers, so the hot path never serializes on a mutex and
+ * workers mostly touch their own ring's cache lines. A worker whose
+ * ring runs dry steals from its victims in FIFO order, which keeps
+ * bursty, uneven loads balanced. The queue mutex and condition
+ * variables are kept only as a parking lot: workers spin briefly on
+ * empty rings before sleeping, and producers only touch the condvar
+ * when every ring is full or a worker is known to be asleep.
+ *
+ * The worker count is sized at runtime (one per online CPU by
+ * default), and workers can optionally be pinned to cores so the
+ * scheduler stops migrating them across sockets.
  */
 
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <pthread.h>
+#include <sched.h>
 #include <unistd.h>
 #include <stdbool.h>
 #include <string.h>
+#include <stdatomic.h>
 #include "../include/thread.h"
+#include "../include/topology.h"
+#include "../include/stats.h"
+#include "../include/profiler.h"
+#define KORRA_LOG_MODULE KORRA_MODULE_CORE
 #include "../include/debug.h"
 
 // Thread pool configuration
-#define MAX_THREADS 8
 #define MAX_QUEUE 256
 
+// Spins on empty rings before a worker parks on the condvar
+#define EMPTY_SPIN_LIMIT 4096
+
+// Cache line size used for padding shared indices
+#define CACHE_LINE_SIZE 64
+
+// One ring slot: tasks become visible to consumers only once the
+// sequence number has been advanced past the enqueue position
+typedef struct {
+    atomic_size_t sequence;
+    thread_task_t task;
+} ring_cell_t;
+
+// Lock-free bounded MPMC ring (Vyukov-style)
+typedef struct {
+    ring_cell_t cells[MAX_QUEUE];
+    char pad0[CACHE_LINE_SIZE];
+    atomic_size_t enqueue_pos;  // producers CAS this forward
+    char pad1[CACHE_LINE_SIZE - sizeof(atomic_size_t)];
+    atomic_size_t dequeue_pos;  // consumers CAS this forward
+    char pad2[CACHE_LINE_SIZE - sizeof(atomic_size_t)];
+} mpmc_ring_t;
+
+// Per-worker state: one private ring per priority class plus the
+// worker's thread handle
+typedef struct {
+    mpmc_ring_t rings[TASK_PRIORITY_COUNT];
+    pthread_t thread;
+    int index;
+    int node;   // NUMA node of the worker's (pinning) CPU
+} worker_t;
+
+// Strict dequeue order across priority classes
+static const task_priority_t dequeue_order[TASK_PRIORITY_COUNT] = {
+    TASK_PRIORITY_HIGH,
+    TASK_PRIORITY_NORMAL,
+    TASK_PRIORITY_LOW
+};
+
 // Thread pool state
 typedef struct {
-    thread_task_t queue[MAX_QUEUE];
-    int queue_size;
-    int head;
-    int tail;
-    pthread_t threads[MAX_THREADS];
+    worker_t* workers;          // sized at init time
+    int num_threads;
+    atomic_size_t next_worker;  // round-robin submit cursor
     pthread_mutex_t queue_mutex;
     pthread_cond_t queue_not_empty;
     pthread_cond_t queue_not_full;
-    bool shutdown;
+    atomic_int sleepers;        // workers parked on queue_not_empty
+    atomic_int full_waiters;    // producers parked on queue_not_full
+    atomic_bool shutdown;
 } thread_pool_t;
 
 static thread_pool_t pool;
 
+// ---- Timer wheel ----
+//
+// Delayed and periodic tasks park on a hashed wheel instead of each
+// burning a thread in a sleep() loop. One timekeeper thread advances
+// the wheel a tick at a time, sleeping on an absolute CLOCK_MONOTONIC
+// deadline between ticks, and hands expired tasks to the worker rings.
+// Insert and expiry are O(1): insert pushes onto one slot's list, a
+// tick touches only its own slot. Delays past one lap of the wheel are
+// carried as a remaining-rounds count on the entry.
+
+// Wheel resolution; expiry jitter is bounded by one tick plus wakeup
+// latency, comfortably sub-millisecond
+#define TIMER_TICK_US 500
+
+// Slots per lap (256ms horizon at 500us ticks); power of two so the
+// slot hash stays a mask
+#define TIMER_WHEEL_SLOTS 512
+
+// Armed timers tracked at once
+#define MAX_TIMERS 256
+
+// One armed timer. Entries live in a fixed array and link into wheel
+// slots by index, so arming allocates nothing.
+typedef struct {
+    thread_task_t task;
+    uint64_t period_us; // 0 = one-shot
+    uint32_t rounds;    // full laps left before this entry expires
+    int slot;           // wheel slot holding the entry, -1 = free
+    int next;           // next entry in the slot's list, -1 = end
+} timer_entry_t;
+
+typedef struct {
+    timer_entry_t entries[MAX_TIMERS];
+    int slots[TIMER_WHEEL_SLOTS];   // head entry index per slot, -1 = empty
+    int free_head;                  // free-list head through entry.next
+    int armed;                      // armed timer count
+    uint64_t cursor;                // last processed tick
+    pthread_mutex_t mutex;
+    pthread_cond_t tick_cond;       // timed out per tick / signalled on arm
+    pthread_t thread;
+    bool running;
+} timer_wheel_t;
+
+static timer_wheel_t wheel;
+
+static void* timer_worker(void* arg);
+static uint64_t now_us(void);
+
+// Arm an entry `delay_us` from now; wheel mutex held. Returns the
+// entry index or -1 when the table is full.
+static int timer_arm(const thread_task_t* task, uint64_t delay_us, uint64_t period_us) {
+    // While the wheel sits idle the timekeeper parks without ticking,
+    // so the cursor goes stale; refresh it before placing the entry
+    if (wheel.armed == 0) {
+        wheel.cursor = now_us() / TIMER_TICK_US;
+    }
+
+    int index = wheel.free_head;
+    if (index < 0) {
+        ERROR_LOG("Timer table full, dropping task %s", task->name);
+        return -1;
+    }
+    wheel.free_head = wheel.entries[index].next;
+
+    // Round the delay up to whole ticks; at least one so the task
+    // never fires on the tick being processed right now
+    uint64_t ticks = (delay_us + TIMER_TICK_US - 1) / TIMER_TICK_US;
+    if (ticks == 0) {
+        ticks = 1;
+    }
+
+    timer_entry_t* entry = &wheel.entries[index];
+    entry->task = *task;
+    entry->period_us = period_us;
+    entry->rounds = (uint32_t)((ticks - 1) / TIMER_WHEEL_SLOTS);
+    entry->slot = (int)((wheel.cursor + ticks) % TIMER_WHEEL_SLOTS);
+    entry->next = wheel.slots[entry->slot];
+    wheel.slots[entry->slot] = index;
+    wheel.armed++;
+    return index;
+}
+
+// Start the timekeeper; called from thread_pool_init
+static int timer_wheel_init(void) {
+    memset(&wheel, 0, sizeof(wheel));
+    for (int i = 0; i < MAX_TIMERS; i++) {
+        wheel.entries[i].slot = -1;
+        wheel.entries[i].next = i + 1;
+    }
+    wheel.entries[MAX_TIMERS - 1].next = -1;
+    for (int i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+        wheel.slots[i] = -1;
+    }
+    wheel.free_head = 0;
+    wheel.cursor = now_us() / TIMER_TICK_US;
+
+    // Timed waits must follow CLOCK_MONOTONIC or a clock step would
+    // stretch every armed timer
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    if (pthread_mutex_init(&wheel.mutex, NULL) != 0 ||
+        pthread_cond_init(&wheel.tick_cond, &attr) != 0) {
+        perror("Failed to initialize timer wheel");
+        pthread_condattr_destroy(&attr);
+        return -1;
+    }
+    pthread_condattr_destroy(&attr);
+
+    wheel.running = true;
+    if (pthread_create(&wheel.thread, NULL, timer_worker, NULL) != 0) {
+        perror("Failed to create timer thread");
+        wheel.running = false;
+        return -1;
+    }
+    return 0;
+}
+
+// Stop the timekeeper; called from thread_pool_shutdown. Armed timers
+// are dropped without firing.
+static void timer_wheel_stop(void) {
+    pthread_mutex_lock(&wheel.mutex);
+    if (!wheel.running) {
+        pthread_mutex_unlock(&wheel.mutex);
+        return;
+    }
+    wheel.running = false;
+    pthread_cond_signal(&wheel.tick_cond);
+    pthread_mutex_unlock(&wheel.mutex);
+
+    pthread_join(wheel.thread, NULL);
+    pthread_mutex_destroy(&wheel.mutex);
+    pthread_cond_destroy(&wheel.tick_cond);
+}
+
+// Initialize ring cells so slot i accepts the i-th enqueue
+static void ring_init(mpmc_ring_t* ring) {
+    for (size_t i = 0; i < MAX_QUEUE; i++) {
+        atomic_store_explicit(&ring->cells[i].sequence, i, memory_order_relaxed);
+    }
+    atomic_store_explicit(&ring->enqueue_pos, 0, memory_order_relaxed);
+    atomic_store_explicit(&ring->dequeue_pos, 0, memory_order_relaxed);
+}
+
+// Try to enqueue a task; returns false if the ring is full
+static bool ring_enqueue(mpmc_ring_t* ring, const thread_task_t* task) {
+    size_t pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+
+    while (true) {
+        ring_cell_t* cell = &ring->cells[pos % MAX_QUEUE];
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            // Slot is free for this position; claim it
+            if (atomic_compare_exchange_weak_explicit(&ring->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                cell->task = *task;
+                atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+                return true;
+            }
+            // CAS failed: pos was refreshed, retry
+        } else if (diff < 0) {
+            // Slot still holds an unconsumed task from a full lap ago
+            return false;
+        } else {
+            // Another producer claimed this position; reload and retry
+            pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+// Try to dequeue a task; returns false if the ring is empty
+static bool ring_dequeue(mpmc_ring_t* ring, thread_task_t* task) {
+    size_t pos = atomic_load_explicit(&ring->dequeue_pos, memory_order_relaxed);
+
+    while (true) {
+        ring_cell_t* cell = &ring->cells[pos % MAX_QUEUE];
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+        if (diff == 0) {
+            // Slot holds a ready task for this position; claim it
+            if (atomic_compare_exchange_weak_explicit(&ring->dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                *task = cell->task;
+                atomic_store_explicit(&cell->sequence, pos + MAX_QUEUE, memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            // Ring is empty at this position
+            return false;
+        } else {
+            // Another consumer claimed this position; reload and retry
+            pos = atomic_load_explicit(&ring->dequeue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+// Monotonic clock in microseconds, for deadline accounting
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+// Pull the next task for a worker. Higher priority classes are drained
+// fully (own ring first for cache warmth, then FIFO steals from
+// victims) before a lower class is touched, so heartbeat and
+// job-result tasks always jump the queue.
+static bool worker_next_task(worker_t* self, thread_task_t* task) {
+    for (int p = 0; p < TASK_PRIORITY_COUNT; p++) {
+        task_priority_t prio = dequeue_order[p];
+
+        if (ring_dequeue(&self->rings[prio], task)) {
+            return true;
+        }
+
+        // Steal from same-node victims first: their payloads live in
+        // memory local to this worker's socket
+        for (int pass = 0; pass < 2; pass++) {
+            for (int i = 1; i < pool.num_threads; i++) {
+                worker_t* victim = &pool.workers[(self->index + i) % pool.num_threads];
+                if ((victim->node == self->node) != (pass == 0)) {
+                    continue;
+                }
+                if (ring_dequeue(&victim->rings[prio], task)) {
+                    DEBUG_LOG("Worker %d stole task %s from worker %d",
+                              self->index, task->name, victim->index);
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+// Execute a task, flagging it if its deadline already passed while it
+// sat in the queue (deadline_us holds an absolute timestamp by now,
+// stamped at submit)
+static void run_task(const thread_task_t* task) {
+    uint64_t start = now_us();
+
+    if (task->deadline_us != 0 && start > task->deadline_us) {
+        WARN_LOG("Task %s started %llu us past its deadline", task->name,
+                 (unsigned long long)(start - task->deadline_us));
+    }
+    if (task->submit_us != 0) {
+        korra_stats_record(KORRA_HIST_QUEUE_WAIT_US, start - task->submit_us);
+    }
+
+    DEBUG_LOG("Executing task %s", task->name);
+    korra_profiler_set_task(task->name);
+    task->function(task->arg);
+    korra_profiler_set_task(NULL);
+
+    uint64_t run = now_us() - start;
+    korra_stats_count(KORRA_CTR_TASKS_EXECUTED, 1);
+    korra_stats_record(KORRA_HIST_TASK_RUN_US, run);
+    korra_stats_task_run(task->name, run);
+}
+
+// Wake a producer stuck on full rings, if any
+static void wake_full_waiter(void) {
+    // Order the dequeue's slot release before this check, mirroring
+    // wake_workers(): a producer parking between its failed submit and
+    // our load would otherwise be missed
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&pool.full_waiters, memory_order_acquire) > 0) {
+        pthread_mutex_lock(&pool.queue_mutex);
+        pthread_cond_signal(&pool.queue_not_full);
+        pthread_mutex_unlock(&pool.queue_mutex);
+    }
+}
+
 // Thread worker function
 static void* thread_worker(void* arg) {
+    worker_t* self = (worker_t*)arg;
+    thread_task_t task;
+    char worker_name[16];
+
+    snprintf(worker_name, sizeof(worker_name), "korra-wrk-%d", self->index);
+    debug_set_thread_name(worker_name);
+    korra_profiler_thread_register();
+
     while (true) {
+        // Fast path: own ring, then steal
+        if (worker_next_task(self, &task)) {
+            wake_full_waiter();
+            run_task(&task);
+            continue;
+        }
+
+        // Spin briefly before paying for a futex sleep
+        bool got_task = false;
+        for (int spin = 0; spin < EMPTY_SPIN_LIMIT; spin++) {
+            if (worker_next_task(self, &task)) {
+                got_task = true;
+                break;
+            }
+            if (atomic_load_explicit(&pool.shutdown, memory_order_acquire)) {
+                break;
+            }
+        }
+
+        if (got_task) {
+            wake_full_waiter();
+            run_task(&task);
+            continue;
+        }
+
+        // Slow path: park on the condvar until a producer wakes us
         pthread_mutex_lock(&pool.queue_mutex);
-        
-        // Wait for tasks
-        while (pool.queue_size == 0 && !pool.shutdown) {
+        atomic_fetch_add_explicit(&pool.sleepers, 1, memory_order_release);
+        // Pairs with the fence in wake_workers(): the recheck below
+        // must see any ring publish that preceded the producer's
+        // sleepers load
+        atomic_thread_fence(memory_order_seq_cst);
+
+        while (!worker_next_task(self, &task)) {
+            if (atomic_load_explicit(&pool.shutdown, memory_order_acquire)) {
+                atomic_fetch_sub_explicit(&pool.sleepers, 1, memory_order_release);
+                pthread_mutex_unlock(&pool.queue_mutex);
+                pthread_exit(NULL);
+            }
             pthread_cond_wait(&pool.queue_not_empty, &pool.queue_mutex);
         }
-        
-        // Check for shutdown
-        if (pool.shutdown && pool.queue_size == 0) {
-            pthread_mutex_unlock(&pool.queue_mutex);
-            pthread_exit(NULL);
-        }
-        
-        // Get task from queue
-        thread_task_t task = pool.queue[pool.head];
-        pool.head = (pool.head + 1) % MAX_QUEUE;
-        pool.queue_size--;
-        
-        // Signal that queue is not full
-        pthread_cond_signal(&pool.queue_not_full);
+
+        atomic_fetch_sub_explicit(&pool.sleepers, 1, memory_order_release);
         pthread_mutex_unlock(&pool.queue_mutex);
-        
-        // Execute task
-        DEBUG_LOG("Executing task %s", task.name);
-        task.function(task.arg);
+
+        wake_full_waiter();
+        run_task(&task);
     }
-    
+
     return NULL;
 }
 
-int thread_pool_init() {
+// Try all workers' rings for the task's priority class, starting from
+// the round-robin cursor
+static bool submit_to_any(const thread_task_t* task) {
+    size_t start = atomic_fetch_add_explicit(&pool.next_worker, 1, memory_order_relaxed);
+
+    for (int i = 0; i < pool.num_threads; i++) {
+        worker_t* target = &pool.workers[(start + i) % pool.num_threads];
+        if (ring_enqueue(&target->rings[task->priority], task)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int thread_pool_init(const thread_pool_config_t* config) {
     DEBUG_LOG("Initializing thread pool");
-    
+
+    long online_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (online_cpus < 1) {
+        online_cpus = 1;
+    }
+
+    // Resolve worker count: explicit config wins, otherwise one per CPU
+    int num_threads = (config && config->num_threads > 0)
+                          ? config->num_threads
+                          : (int)online_cpus;
+    bool pin_workers = config && config->pin_workers;
+
     // Initialize pool state
     memset(&pool, 0, sizeof(thread_pool_t));
-    pool.shutdown = false;
-    
+    pool.num_threads = num_threads;
+    pool.workers = calloc(num_threads, sizeof(worker_t));
+    if (!pool.workers) {
+        ERROR_LOG("Failed to allocate %d worker slots", num_threads);
+        return -1;
+    }
+
+    for (int i = 0; i < num_threads; i++) {
+        for (int p = 0; p < TASK_PRIORITY_COUNT; p++) {
+            ring_init(&pool.workers[i].rings[p]);
+        }
+        pool.workers[i].index = i;
+        // Node of the CPU this worker pins to (advisory when pinning
+        // is off, but keeps node-affine submits and steals grouped)
+        pool.workers[i].node = korra_topology_node_of_cpu(i % (int)online_cpus);
+    }
+    atomic_store(&pool.next_worker, 0);
+    atomic_store(&pool.shutdown, false);
+    atomic_store(&pool.sleepers, 0);
+    atomic_store(&pool.full_waiters, 0);
+
     // Initialize mutex and condition variables
     if (pthread_mutex_init(&pool.queue_mutex, NULL) != 0) {
         perror("Failed to initialize queue mutex");
         return -1;
     }
-    
+
     if (pthread_cond_init(&pool.queue_not_empty, NULL) != 0) {
         perror("Failed to initialize queue not empty condition");
         return -1;
     }
-    
+
     if (pthread_cond_init(&pool.queue_not_full, NULL) != 0) {
         perror("Failed to initialize queue not full condition");
         return -1;
     }
-    
+
     // Create worker threads
-    for (int i = 0; i < MAX_THREADS; i++) {
-        if (pthread_create(&pool.threads[i], NULL, thread_worker, NULL) != 0) {
+    for (int i = 0; i < num_threads; i++) {
+        if (pthread_create(&pool.workers[i].thread, NULL, thread_worker, &pool.workers[i]) != 0) {
             perror("Failed to create worker thread");
             return -1;
         }
+
+        // Optionally pin the worker so the scheduler stops migrating
+        // it across cores (and sockets, on multi-socket nodes)
+        if (pin_workers) {
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+            CPU_SET(i % online_cpus, &cpu_set);
+            if (pthread_setaffinity_np(pool.workers[i].thread, sizeof(cpu_set), &cpu_set) != 0) {
+                WARN_LOG("Failed to pin worker %d to CPU %ld", i, i % online_cpus);
+            }
+        }
+    }
+
+    // Timer wheel for delayed and periodic submits
+    if (timer_wheel_init() != 0) {
+        return -1;
     }
-    
-    DEBUG_LOG("Thread pool initialized with %d threads", MAX_THREADS);
+
+    DEBUG_LOG("Thread pool initialized with %d threads (pinning %s)",
+              num_threads, pin_workers ? "on" : "off");
     return 0;
 }
 
-int thread_pool_submit(thread_task_t task) {
-    pthread_mutex_lock(&pool.queue_mutex);
-    
-    // Wait if queue is full
-    while (pool.queue_size == MAX_QUEUE && !pool.shutdown) {
-        pthread_cond_wait(&pool.queue_not_full, &pool.queue_mutex);
-    }
-    
-    // Don't accept new tasks if shutting down
-    if (pool.shutdown) {
+// Normalize a caller-provided task: clamp garbage priorities rather
+// than indexing out of bounds, turn the relative deadline into an
+// absolute timestamp so workers can tell how late a task started, and
+// stamp the submit time for queue-wait accounting
+static void prepare_task(thread_task_t* task) {
+    if (task->priority < 0 || task->priority >= TASK_PRIORITY_COUNT) {
+        task->priority = TASK_PRIORITY_NORMAL;
+    }
+
+    uint64_t now = now_us();
+    if (task->deadline_us != 0) {
+        task->deadline_us += now;
+    }
+    task->submit_us = now;
+    korra_stats_count(KORRA_CTR_TASKS_SUBMITTED, 1);
+}
+
+// Enqueue one task, parking on queue_not_full if every ring is full.
+// Returns -1 if the pool is shutting down.
+static int enqueue_blocking(const thread_task_t* task) {
+    while (true) {
+        // Don't accept new tasks if shutting down
+        if (atomic_load_explicit(&pool.shutdown, memory_order_acquire)) {
+            return -1;
+        }
+
+        // Fast path: lock-free enqueue into some worker's ring
+        if (submit_to_any(task)) {
+            return 0;
+        }
+
+        // Every ring is full: park until a worker drains a slot
+        pthread_mutex_lock(&pool.queue_mutex);
+        atomic_fetch_add_explicit(&pool.full_waiters, 1, memory_order_release);
+        // Pairs with the fence in wake_full_waiter(): the retry below
+        // must see any slot a worker drained before it checked for
+        // parked producers
+        atomic_thread_fence(memory_order_seq_cst);
+
+        while (!submit_to_any(task)) {
+            if (atomic_load_explicit(&pool.shutdown, memory_order_acquire)) {
+                atomic_fetch_sub_explicit(&pool.full_waiters, 1, memory_order_release);
+                pthread_mutex_unlock(&pool.queue_mutex);
+                return -1;
+            }
+            pthread_cond_wait(&pool.queue_not_full, &pool.queue_mutex);
+        }
+
+        atomic_fetch_sub_explicit(&pool.full_waiters, 1, memory_order_release);
         pthread_mutex_unlock(&pool.queue_mutex);
-        return -1;
+        return 0;
+    }
+}
+
+// Wake up to `count` sleeping workers in one synchronization episode
+static void wake_workers(int count) {
+    // The ring publish above and this sleepers load must not reorder
+    // against a parking worker's increment-then-recheck, or both sides
+    // miss each other and the task strands until the next submit
+    atomic_thread_fence(memory_order_seq_cst);
+    int sleepers = atomic_load_explicit(&pool.sleepers, memory_order_acquire);
+    if (sleepers <= 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool.queue_mutex);
+    if (count >= sleepers) {
+        pthread_cond_broadcast(&pool.queue_not_empty);
+    } else {
+        for (int i = 0; i < count; i++) {
+            pthread_cond_signal(&pool.queue_not_empty);
+        }
     }
-    
-    // Add task to queue
-    pool.queue[pool.tail] = task;
-    pool.tail = (pool.tail + 1) % MAX_QUEUE;
-    pool.queue_size++;
-    
-    DEBUG_LOG("Task %s added to queue, size: %d", task.name, pool.queue_size);
-    
-    // Signal that queue is not empty
-    pthread_cond_signal(&pool.queue_not_empty);
     pthread_mutex_unlock(&pool.queue_mutex);
-    
+}
+
+// Timekeeper thread: sleep to each tick boundary on the monotonic
+// clock, expire the tick's wheel slot, and hand due tasks to the
+// worker rings. Runs no task bodies itself.
+static void* timer_worker(void* arg) {
+    (void)arg;
+    debug_set_thread_name("korra-timer");
+
+    // Due tasks are collected under the lock and submitted outside it,
+    // since a submit can park on full rings. Sized for a full table
+    // expiring while a catch-up tick re-expires fast periodics.
+    static thread_task_t due[MAX_TIMERS * 2];
+
+    pthread_mutex_lock(&wheel.mutex);
+    while (wheel.running) {
+        if (wheel.armed == 0) {
+            // Nothing armed: park until a submit arrives
+            pthread_cond_wait(&wheel.tick_cond, &wheel.mutex);
+            continue;
+        }
+
+        // Sleep until the next tick boundary
+        uint64_t deadline_us = (wheel.cursor + 1) * TIMER_TICK_US;
+        struct timespec deadline = {
+            .tv_sec = (time_t)(deadline_us / 1000000),
+            .tv_nsec = (long)((deadline_us % 1000000) * 1000)
+        };
+        while (wheel.running && now_us() < deadline_us) {
+            pthread_cond_timedwait(&wheel.tick_cond, &wheel.mutex, &deadline);
+        }
+        if (!wheel.running) {
+            break;
+        }
+
+        // Advance tick by tick to now, draining each slot as its turn
+        // comes. Entries still owed laps just decrement their count.
+        int num_due = 0;
+        uint64_t now_tick = now_us() / TIMER_TICK_US;
+        while (wheel.cursor < now_tick && num_due < MAX_TIMERS) {
+            wheel.cursor++;
+            int slot = (int)(wheel.cursor % TIMER_WHEEL_SLOTS);
+
+            // Detach the slot's chain before walking it: a periodic
+            // whose period is an exact lap re-arms into this very slot,
+            // and walking the live list would revisit it this tick -
+            // firing a lap early at best, spinning on a one-entry list
+            // at worst
+            int chain = wheel.slots[slot];
+            wheel.slots[slot] = -1;
+            int* link = &chain;
+
+            while (*link >= 0 && num_due < MAX_TIMERS * 2) {
+                int index = *link;
+                timer_entry_t* entry = &wheel.entries[index];
+
+                if (entry->rounds > 0) {
+                    entry->rounds--;
+                    link = &entry->next;
+                    continue;
+                }
+
+                *link = entry->next;
+                due[num_due] = entry->task;
+                num_due++;
+
+                if (entry->period_us > 0) {
+                    // Periodic: re-arm in place so the id handed to the
+                    // caller stays valid for cancellation
+                    uint64_t ticks = (entry->period_us + TIMER_TICK_US - 1) / TIMER_TICK_US;
+                    if (ticks == 0) {
+                        ticks = 1;
+                    }
+                    entry->rounds = (uint32_t)((ticks - 1) / TIMER_WHEEL_SLOTS);
+                    entry->slot = (int)((wheel.cursor + ticks) % TIMER_WHEEL_SLOTS);
+                    entry->next = wheel.slots[entry->slot];
+                    wheel.slots[entry->slot] = index;
+                } else {
+                    entry->slot = -1;
+                    entry->next = wheel.free_head;
+                    wheel.free_head = index;
+                    wheel.armed--;
+                }
+            }
+
+            // Entries still owed laps go back; same-tick re-arms are
+            // already in the slot, so splice in front of them
+            if (chain >= 0) {
+                int tail = chain;
+                while (wheel.entries[tail].next >= 0) {
+                    tail = wheel.entries[tail].next;
+                }
+                wheel.entries[tail].next = wheel.slots[slot];
+                wheel.slots[slot] = chain;
+            }
+        }
+
+        pthread_mutex_unlock(&wheel.mutex);
+        for (int i = 0; i < num_due; i++) {
+            if (thread_pool_submit(due[i]) != 0) {
+                WARN_LOG("Dropped expired timer task %s", due[i].name);
+            }
+        }
+        pthread_mutex_lock(&wheel.mutex);
+    }
+
+    pthread_mutex_unlock(&wheel.mutex);
+    return NULL;
+}
+
+int thread_pool_submit_delayed(thread_task_t task, uint64_t delay_us) {
+    if (!task.function) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&wheel.mutex);
+    if (!wheel.running) {
+        pthread_mutex_unlock(&wheel.mutex);
+        return -1;
+    }
+
+    int index = timer_arm(&task, delay_us, 0);
+    if (index >= 0) {
+        pthread_cond_signal(&wheel.tick_cond);
+    }
+    pthread_mutex_unlock(&wheel.mutex);
+    return index >= 0 ? 0 : -1;
+}
+
+int thread_pool_submit_periodic(thread_task_t task, uint64_t delay_us,
+                                uint64_t period_us) {
+    if (!task.function || period_us == 0) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&wheel.mutex);
+    if (!wheel.running) {
+        pthread_mutex_unlock(&wheel.mutex);
+        return -1;
+    }
+
+    int index = timer_arm(&task, delay_us, period_us);
+    if (index >= 0) {
+        pthread_cond_signal(&wheel.tick_cond);
+    }
+    pthread_mutex_unlock(&wheel.mutex);
+    return index;
+}
+
+int thread_pool_cancel_timer(int timer_id) {
+    if (timer_id < 0 || timer_id >= MAX_TIMERS) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&wheel.mutex);
+    timer_entry_t* entry = &wheel.entries[timer_id];
+    if (entry->slot < 0) {
+        pthread_mutex_unlock(&wheel.mutex);
+        return -1;
+    }
+
+    // Unlink from the wheel slot, then back onto the free list
+    int* link = &wheel.slots[entry->slot];
+    while (*link >= 0 && *link != timer_id) {
+        link = &wheel.entries[*link].next;
+    }
+    if (*link == timer_id) {
+        *link = entry->next;
+    }
+    entry->slot = -1;
+    entry->next = wheel.free_head;
+    wheel.free_head = timer_id;
+    wheel.armed--;
+    pthread_mutex_unlock(&wheel.mutex);
+
+    DEBUG_LOG("Cancelled timer %d", timer_id);
+    return 0;
+}
+
+// ---- Completions ----
+//
+// A completion decouples a task from the async work it would
+// otherwise block on: the task registers its follow-up and returns
+// the worker to the pool, and whoever finishes the async operation
+// (FFI callback, event loop) fires the completion to enqueue the
+// follow-up. Handles are refcounted so the registering side and the
+// firing side can release in either order.
+
+// Follow-up tasks per completion
+#define MAX_CONTINUATIONS 8
+
+struct thread_completion {
+    pthread_mutex_t mutex;
+    atomic_int refs;
+    bool fired;
+    void* result;
+    thread_task_t pending[MAX_CONTINUATIONS];
+    int num_pending;
+};
+
+thread_completion_t* thread_completion_create(void) {
+    thread_completion_t* completion = calloc(1, sizeof(thread_completion_t));
+    if (!completion) {
+        ERROR_LOG("Failed to allocate completion");
+        return NULL;
+    }
+
+    pthread_mutex_init(&completion->mutex, NULL);
+    atomic_store(&completion->refs, 1);
+    return completion;
+}
+
+void thread_completion_ref(thread_completion_t* completion) {
+    atomic_fetch_add_explicit(&completion->refs, 1, memory_order_relaxed);
+}
+
+void thread_completion_release(thread_completion_t* completion) {
+    if (!completion) {
+        return;
+    }
+    if (atomic_fetch_sub_explicit(&completion->refs, 1, memory_order_acq_rel) == 1) {
+        if (!completion->fired && completion->num_pending > 0) {
+            WARN_LOG("Completion dropped with %d continuations never fired",
+                     completion->num_pending);
+        }
+        pthread_mutex_destroy(&completion->mutex);
+        free(completion);
+    }
+}
+
+int thread_completion_then(thread_completion_t* completion, thread_task_t task) {
+    if (!completion || !task.function) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&completion->mutex);
+    if (completion->fired) {
+        // Already fired: the follow-up runs right away
+        pthread_mutex_unlock(&completion->mutex);
+        return thread_pool_submit(task);
+    }
+
+    if (completion->num_pending >= MAX_CONTINUATIONS) {
+        pthread_mutex_unlock(&completion->mutex);
+        ERROR_LOG("Completion continuation table full");
+        return -1;
+    }
+
+    completion->pending[completion->num_pending++] = task;
+    pthread_mutex_unlock(&completion->mutex);
     return 0;
 }
 
+int thread_completion_fire(thread_completion_t* completion, void* result) {
+    if (!completion) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&completion->mutex);
+    if (completion->fired) {
+        pthread_mutex_unlock(&completion->mutex);
+        return 0;
+    }
+    completion->fired = true;
+    completion->result = result;
+
+    // Move the continuations out so submits (which can park on full
+    // rings) run without the completion lock
+    thread_task_t todo[MAX_CONTINUATIONS];
+    int count = completion->num_pending;
+    memcpy(todo, completion->pending, count * sizeof(thread_task_t));
+    completion->num_pending = 0;
+    pthread_mutex_unlock(&completion->mutex);
+
+    int submitted = 0;
+    for (int i = 0; i < count; i++) {
+        if (thread_pool_submit(todo[i]) == 0) {
+            submitted++;
+        } else {
+            WARN_LOG("Dropped continuation %s on completion fire", todo[i].name);
+        }
+    }
+
+    DEBUG_LOG("Completion fired, %d continuations submitted", submitted);
+    return submitted;
+}
+
+void* thread_completion_result(thread_completion_t* completion) {
+    return completion ? completion->result : NULL;
+}
+
+int thread_pool_submit(thread_task_t task) {
+    prepare_task(&task);
+
+    if (enqueue_blocking(&task) != 0) {
+        return -1;
+    }
+
+    DEBUG_LOG("Task %s added to queue", task.name);
+
+    // Only pay for the condvar when a worker is actually asleep
+    wake_workers(1);
+    return 0;
+}
+
+// ---- Backpressure ----
+//
+// thread_pool_submit() parks the producer when every ring is full,
+// which is exactly wrong for the transport receive path: it stops
+// draining the socket and turns a local overload into peer timeouts.
+// The policy below lets such producers shed instead - each priority
+// class has an occupancy threshold, so state-sync and stats work
+// backs off while heartbeats keep landing until the rings are
+// physically full.
+
+// Default thresholds, indexed by task_priority_t (NORMAL, HIGH, LOW)
+static const int default_shed_pct[TASK_PRIORITY_COUNT] = { 85, 100, 60 };
+
+static struct {
+    int max_pct[TASK_PRIORITY_COUNT];
+    thread_shed_callback_t shed;
+    void* shed_ctx;
+} pressure = { { 85, 100, 60 }, NULL, NULL };
+
+// Occupied share of all rings for one priority class, in percent.
+// Relaxed reads of the ring cursors; an approximate answer is fine
+// for an admission decision.
+static int class_occupancy_pct(task_priority_t prio) {
+    size_t used = 0;
+    for (int i = 0; i < pool.num_threads; i++) {
+        mpmc_ring_t* ring = &pool.workers[i].rings[prio];
+        size_t enq = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+        size_t deq = atomic_load_explicit(&ring->dequeue_pos, memory_order_relaxed);
+        if (enq > deq) {
+            used += enq - deq;
+        }
+    }
+    return (int)(used * 100 / ((size_t)pool.num_threads * MAX_QUEUE));
+}
+
+int thread_pool_set_backpressure(const thread_pool_backpressure_t* config) {
+    if (!config) {
+        memcpy(pressure.max_pct, default_shed_pct, sizeof(pressure.max_pct));
+        pressure.shed = NULL;
+        pressure.shed_ctx = NULL;
+        return 0;
+    }
+
+    for (int p = 0; p < TASK_PRIORITY_COUNT; p++) {
+        int pct = config->max_occupancy_pct[p];
+        pressure.max_pct[p] = (pct > 0 && pct <= 100) ? pct : default_shed_pct[p];
+    }
+    pressure.shed = config->shed_callback;
+    pressure.shed_ctx = config->shed_ctx;
+    DEBUG_LOG("Backpressure policy set: %d/%d/%d%%",
+              pressure.max_pct[TASK_PRIORITY_HIGH],
+              pressure.max_pct[TASK_PRIORITY_NORMAL],
+              pressure.max_pct[TASK_PRIORITY_LOW]);
+    return 0;
+}
+
+// Reject one task: count it, tell the producer, report failure
+static int shed_task(const thread_task_t* task) {
+    korra_stats_count(KORRA_CTR_TASKS_SHED, 1);
+    WARN_LOG("Shed task %s (priority %d)", task->name, task->priority);
+    if (pressure.shed) {
+        pressure.shed(task, pressure.shed_ctx);
+    }
+    return -1;
+}
+
+int thread_pool_try_submit(thread_task_t task) {
+    prepare_task(&task);
+
+    if (atomic_load_explicit(&pool.shutdown, memory_order_acquire)) {
+        return -1;
+    }
+
+    // Admission check: shed before enqueueing once this class is over
+    // its share of the rings
+    if (class_occupancy_pct(task.priority) >= pressure.max_pct[task.priority]) {
+        return shed_task(&task);
+    }
+
+    // No blocking fallback: full rings mean shed, not park
+    if (!submit_to_any(&task)) {
+        return shed_task(&task);
+    }
+
+    DEBUG_LOG("Task %s added to queue", task.name);
+    wake_workers(1);
+    return 0;
+}
+
+int thread_pool_submit_on_node(thread_task_t task, int node) {
+    prepare_task(&task);
+
+    if (atomic_load_explicit(&pool.shutdown, memory_order_acquire)) {
+        return -1;
+    }
+
+    // Try the requested node's workers first so the task runs next to
+    // its payload's memory
+    size_t start = atomic_fetch_add_explicit(&pool.next_worker, 1, memory_order_relaxed);
+    for (int i = 0; i < pool.num_threads; i++) {
+        worker_t* target = &pool.workers[(start + i) % pool.num_threads];
+        if (target->node != node) {
+            continue;
+        }
+        if (ring_enqueue(&target->rings[task.priority], &task)) {
+            DEBUG_LOG("Task %s added to queue on node %d", task.name, node);
+            wake_workers(1);
+            return 0;
+        }
+    }
+
+    // Node workers full or node unknown: any worker beats rejection
+    if (enqueue_blocking(&task) != 0) {
+        return -1;
+    }
+    wake_workers(1);
+    return 0;
+}
+
+int thread_pool_submit_batch(thread_task_t* tasks, int count) {
+    if (!tasks || count < 0) {
+        return -1;
+    }
+
+    // Enqueue the whole array before touching the condvar: workers
+    // that are awake pick tasks up as they land, and sleepers are
+    // woken once at the end instead of once per task
+    int submitted = 0;
+    for (int i = 0; i < count; i++) {
+        prepare_task(&tasks[i]);
+        if (enqueue_blocking(&tasks[i]) != 0) {
+            break;
+        }
+        submitted++;
+    }
+
+    DEBUG_LOG("Submitted batch of %d/%d tasks", submitted, count);
+
+    if (submitted > 0) {
+        wake_workers(submitted);
+    }
+
+    return (submitted == count) ? submitted : -1;
+}
+
 int thread_pool_shutdown() {
     DEBUG_LOG("Shutting down thread pool");
-    
+
+    // Stop the timekeeper first so no new tasks land in the rings
+    timer_wheel_stop();
+
     pthread_mutex_lock(&pool.queue_mutex);
-    pool.shutdown = true;
+    atomic_store_explicit(&pool.shutdown, true, memory_order_release);
     pthread_cond_broadcast(&pool.queue_not_empty);
     pthread_cond_broadcast(&pool.queue_not_full);
     pthread_mutex_unlock(&pool.queue_mutex);
-    
+
     // Wait for threads to finish
-    for (int i = 0; i < MAX_THREADS; i++) {
-        if (pthread_join(pool.threads[i], NULL) != 0) {
+    for (int i = 0; i < pool.num_threads; i++) {
+        if (pthread_join(pool.workers[i].thread, NULL) != 0) {
             perror("Failed to join worker thread");
             return -1;
         }
     }
-    
+
     // Destroy mutex and condition variables
     pthread_mutex_destroy(&pool.queue_mutex);
     pthread_cond_destroy(&pool.queue_not_empty);
     pthread_cond_destroy(&pool.queue_not_full);
-    
+
+    free(pool.workers);
+    pool.workers = NULL;
+    pool.num_threads = 0;
+
     DEBUG_LOG("Thread pool shutdown complete");
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,94 @@
+/**
+ * @file topology.c
+ * @brief CPU/NUMA topology discovery for KORRA
+ *
+ * Reads the node-to-CPU map from sysfs once, so the pool and allocator
+ * can keep tasks and buffers on the socket that owns the memory
+ * without linking libnuma. Everything degrades to a single node when
+ * the kernel exposes no topology.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <pthread.h>
+#include "../include/topology.h"
+#define KORRA_LOG_MODULE KORRA_MODULE_CORE
+#include "../include/debug.h"
+
+// Upper bounds for the static maps
+#define MAX_TOPO_NODES 16
+#define MAX_TOPO_CPUS 1024
+
+static int num_nodes = 1;
+static int cpu_node[MAX_TOPO_CPUS];     // cpu index -> node index
+static pthread_once_t topo_once = PTHREAD_ONCE_INIT;
+
+// Parse a sysfs cpulist ("0-15,32-47") and tag those CPUs with `node`
+static void parse_cpulist(const char* list, int node) {
+    const char* p = list;
+
+    while (*p) {
+        char* end;
+        long first = strtol(p, &end, 10);
+        long last = first;
+        if (end == p) {
+            break;
+        }
+        if (*end == '-') {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+        }
+        for (long cpu = first; cpu <= last && cpu < MAX_TOPO_CPUS; cpu++) {
+            if (cpu >= 0) {
+                cpu_node[cpu] = node;
+            }
+        }
+        p = (*end == ',') ? end + 1 : end;
+    }
+}
+
+static void topology_discover(void) {
+    memset(cpu_node, 0, sizeof(cpu_node));
+    num_nodes = 1;
+
+    for (int node = 0; node < MAX_TOPO_NODES; node++) {
+        char path[128];
+        snprintf(path, sizeof(path),
+                 "/sys/devices/system/node/node%d/cpulist", node);
+
+        FILE* file = fopen(path, "r");
+        if (!file) {
+            break;
+        }
+
+        char list[4096];
+        if (fgets(list, sizeof(list), file)) {
+            parse_cpulist(list, node);
+            num_nodes = node + 1;
+        }
+        fclose(file);
+    }
+
+    DEBUG_LOG("Topology: %d NUMA node%s", num_nodes, num_nodes == 1 ? "" : "s");
+}
+
+int korra_topology_num_nodes(void) {
+    pthread_once(&topo_once, topology_discover);
+    return num_nodes;
+}
+
+int korra_topology_node_of_cpu(int cpu) {
+    pthread_once(&topo_once, topology_discover);
+    if (cpu < 0 || cpu >= MAX_TOPO_CPUS) {
+        return 0;
+    }
+    return cpu_node[cpu];
+}
+
+int korra_topology_current_node(void) {
+    return korra_topology_node_of_cpu(sched_getcpu());
+}
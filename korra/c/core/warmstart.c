@@ -0,0 +1,214 @@
+/**
+ * @file warmstart.c
+ * @brief Parallel boot and agent pre-warming for KORRA
+ *
+ * Cold start used to be strictly sequential: pool, then transport,
+ * then FFI, then the first create_agent() calls with their JSON
+ * parsing - several seconds before a freshly autoscaled node took its
+ * first job. Here the three subsystem inits run on their own threads
+ * and the node starts accepting as soon as they join; agent warmup is
+ * pushed onto low-priority pool tasks that create_agent() +
+ * destroy_agent() each pair from the warm-state file, parking ready
+ * handles in the warm cache while real jobs jump ahead of them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "../include/warmstart.h"
+#include "../include/transport.h"
+#define KORRA_LOG_MODULE KORRA_MODULE_CORE
+#include "../include/debug.h"
+
+// Longest accepted warm-state line (type + tab + config JSON)
+#define WARM_LINE_MAX 4096
+
+// Background warmup progress
+static atomic_int warm_pending;
+static atomic_int warm_done;
+static pthread_mutex_t warm_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t warm_cond = PTHREAD_COND_INITIALIZER;
+
+// One subsystem init running on its own thread
+typedef struct {
+    const korra_warmstart_config_t* config;
+    int result;
+} init_job_t;
+
+static void* init_pool(void* arg) {
+    init_job_t* job = arg;
+    job->result = thread_pool_init(job->config->pool);
+    return NULL;
+}
+
+static void* init_transport(void* arg) {
+    init_job_t* job = arg;
+    job->result = transport_init(job->config->port, job->config->is_server);
+    return NULL;
+}
+
+static void* init_ffi(void* arg) {
+    init_job_t* job = arg;
+    job->result = rust_ffi_init(job->config->callbacks);
+    return NULL;
+}
+
+// Drop one unit of pending warmup work, waking waiters on the last
+static void warm_release(void) {
+    if (atomic_fetch_sub(&warm_pending, 1) == 1) {
+        pthread_mutex_lock(&warm_mutex);
+        pthread_cond_broadcast(&warm_cond);
+        pthread_mutex_unlock(&warm_mutex);
+        INFO_LOG("Agent warmup complete: %d agents pre-warmed",
+                 atomic_load(&warm_done));
+    }
+}
+
+// Pool task: pre-create one agent and park it in the warm cache
+typedef struct {
+    char* agent_type;
+    char* config;
+} warm_job_t;
+
+static void warm_agent_task(void* arg) {
+    warm_job_t* job = arg;
+
+    agent_handle_t handle = create_agent(job->agent_type, job->config);
+    if (handle) {
+        // destroy_agent parks identically configured agents warm, so
+        // the next real create_agent() skips Rust and the JSON parse
+        destroy_agent(handle);
+        atomic_fetch_add(&warm_done, 1);
+    } else {
+        WARN_LOG("Failed to pre-warm agent type %s", job->agent_type);
+    }
+
+    free(job->agent_type);
+    free(job->config);
+    free(job);
+    warm_release();
+}
+
+// Queue one warm task per usable warm-state line
+static int queue_warmup(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        // A missing file is a cold-cache boot, not an error
+        DEBUG_LOG("No warm-state file at %s", path);
+        return 0;
+    }
+
+    char line[WARM_LINE_MAX];
+    int queued = 0;
+
+    // Held while queueing so a fast worker draining early tasks can't
+    // make the warmup look finished mid-file
+    atomic_fetch_add(&warm_pending, 1);
+
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') {
+            continue;
+        }
+
+        char* tab = strchr(line, '\t');
+        if (!tab) {
+            WARN_LOG("Malformed warm-state line skipped: %.32s", line);
+            continue;
+        }
+        *tab = '\0';
+
+        warm_job_t* job = malloc(sizeof(warm_job_t));
+        if (!job) {
+            break;
+        }
+        job->agent_type = strdup(line);
+        job->config = strdup(tab + 1);
+        if (!job->agent_type || !job->config) {
+            free(job->agent_type);
+            free(job->config);
+            free(job);
+            break;
+        }
+
+        // Low priority: a real job arriving early outranks warmup
+        thread_task_t task = { .function = warm_agent_task, .arg = job,
+                               .priority = TASK_PRIORITY_LOW };
+        snprintf(task.name, sizeof(task.name), "warm-%s", job->agent_type);
+
+        atomic_fetch_add(&warm_pending, 1);
+        if (thread_pool_submit(task) != 0) {
+            atomic_fetch_sub(&warm_pending, 1);
+            free(job->agent_type);
+            free(job->config);
+            free(job);
+            break;
+        }
+        queued++;
+    }
+
+    fclose(file);
+    warm_release();
+    DEBUG_LOG("Queued %d agent warmup tasks from %s", queued, path);
+    return queued;
+}
+
+int korra_warmstart_begin(const korra_warmstart_config_t* config) {
+    if (!config) {
+        return -1;
+    }
+
+    atomic_store(&warm_pending, 0);
+    atomic_store(&warm_done, 0);
+
+    // The three subsystems share no state during init; overlap them
+    init_job_t jobs[3] = { { config, -1 }, { config, -1 }, { config, -1 } };
+    void* (*entries[3])(void*) = { init_pool, init_transport, init_ffi };
+    pthread_t threads[3];
+
+    for (int i = 0; i < 3; i++) {
+        if (pthread_create(&threads[i], NULL, entries[i], &jobs[i]) != 0) {
+            perror("Failed to create init thread");
+            // Run it inline rather than booting half a node
+            entries[i](&jobs[i]);
+            threads[i] = 0;
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        if (threads[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+
+    if (jobs[0].result != 0 || jobs[1].result != 0 || jobs[2].result != 0) {
+        ERROR_LOG("Warm start failed: pool=%d transport=%d ffi=%d",
+                  jobs[0].result, jobs[1].result, jobs[2].result);
+        return -1;
+    }
+
+    // The node is accepting from here on; warmup trails behind on the
+    // pool and early jobs simply queue ahead of it
+    if (config->warm_state_path) {
+        queue_warmup(config->warm_state_path);
+    }
+
+    INFO_LOG("Warm start: subsystems up, %d agent warmups pending",
+             atomic_load(&warm_pending));
+    return 0;
+}
+
+bool korra_warmstart_ready(void) {
+    return atomic_load(&warm_pending) == 0;
+}
+
+int korra_warmstart_wait(void) {
+    pthread_mutex_lock(&warm_mutex);
+    while (atomic_load(&warm_pending) > 0) {
+        pthread_cond_wait(&warm_cond, &warm_mutex);
+    }
+    pthread_mutex_unlock(&warm_mutex);
+    return atomic_load(&warm_done);
+}
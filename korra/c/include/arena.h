@@ -0,0 +1,67 @@
+/**
+ * @file arena.h
+ * @brief Region allocator for short-lived, bursty allocations
+ */
+
+#ifndef KORRA_ARENA_H
+#define KORRA_ARENA_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Opaque arena handle. Allocations are bump-pointer cheap and are all
+// released together by reset or destroy; there is no per-allocation
+// free.
+typedef struct korra_arena korra_arena_t;
+
+/**
+ * Create an arena
+ *
+ * @param initial_size Size of the first block in bytes
+ * @return Arena handle, or NULL on failure
+ */
+korra_arena_t* korra_arena_create(size_t initial_size);
+
+/**
+ * Allocate from an arena (16-byte aligned)
+ *
+ * Grows by chaining new blocks when the current one is exhausted.
+ *
+ * @param arena Arena to allocate from
+ * @param size Number of bytes needed
+ * @return Pointer to the allocation, or NULL on failure
+ */
+void* korra_arena_alloc(korra_arena_t* arena, size_t size);
+
+/**
+ * Check whether a pointer lies inside an arena's blocks
+ *
+ * @param arena Arena to check against
+ * @param ptr Pointer to test
+ * @return true if the pointer was allocated from this arena
+ */
+bool korra_arena_contains(const korra_arena_t* arena, const void* ptr);
+
+/**
+ * Release every allocation at once, keeping the first block for reuse
+ *
+ * @param arena Arena to reset
+ */
+void korra_arena_reset(korra_arena_t* arena);
+
+/**
+ * Destroy an arena and free all of its blocks
+ *
+ * @param arena Arena to destroy (NULL is ignored)
+ */
+void korra_arena_destroy(korra_arena_t* arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // KORRA_ARENA_H
@@ -0,0 +1,67 @@
+/**
+ * @file bufpool.h
+ * @brief Size-classed, reference-counted buffer pool for KORRA
+ */
+
+#ifndef KORRA_BUFPOOL_H
+#define KORRA_BUFPOOL_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Opaque pooled buffer handle. A buffer starts with one reference and
+// is returned to the pool when the last reference is released, so a
+// payload can be handed from the transport to a pool task to the FFI
+// layer without copies.
+typedef struct korra_buf korra_buf_t;
+
+/**
+ * Allocate a buffer of at least `size` bytes from the pool
+ *
+ * Served from a per-thread cache when possible. Sizes above the
+ * largest size class fall back to the heap but keep the same handle
+ * semantics.
+ *
+ * @param size Number of bytes needed
+ * @return Buffer handle with refcount 1, or NULL on failure
+ */
+korra_buf_t* korra_buf_alloc(size_t size);
+
+/**
+ * Get the usable data region of a buffer
+ *
+ * @param buf Buffer handle
+ * @return Pointer to the buffer's data
+ */
+void* korra_buf_data(korra_buf_t* buf);
+
+/**
+ * Get the usable capacity of a buffer
+ *
+ * @param buf Buffer handle
+ * @return Capacity in bytes (>= the size passed to korra_buf_alloc)
+ */
+size_t korra_buf_capacity(const korra_buf_t* buf);
+
+/**
+ * Take an additional reference on a buffer
+ *
+ * @param buf Buffer handle
+ */
+void korra_buf_ref(korra_buf_t* buf);
+
+/**
+ * Drop a reference; returns the buffer to the pool on the last one
+ *
+ * @param buf Buffer handle (NULL is ignored)
+ */
+void korra_buf_release(korra_buf_t* buf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // KORRA_BUFPOOL_H
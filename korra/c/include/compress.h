@@ -0,0 +1,53 @@
+/**
+ * @file compress.h
+ * @brief LZ4-style block compression for KORRA payloads
+ */
+
+#ifndef KORRA_COMPRESS_H
+#define KORRA_COMPRESS_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Worst-case compressed size for an input of `size` bytes
+ *
+ * @param size Input size in bytes
+ * @return Upper bound on korra_compress output size
+ */
+size_t korra_compress_bound(size_t size);
+
+/**
+ * Compress a block
+ *
+ * Byte-oriented LZ77 with 16-bit offsets, compatible in spirit with
+ * the LZ4 block format: fast enough for the transport hot path and
+ * effective on the repetitive state blobs that dominate sync traffic.
+ *
+ * @param src Input data
+ * @param src_size Input size in bytes
+ * @param dst Output buffer
+ * @param dst_capacity Output buffer size (use korra_compress_bound)
+ * @return Compressed size in bytes, or -1 if dst is too small
+ */
+long korra_compress(const void* src, size_t src_size, void* dst, size_t dst_capacity);
+
+/**
+ * Decompress a block produced by korra_compress
+ *
+ * @param src Compressed data
+ * @param src_size Compressed size in bytes
+ * @param dst Output buffer
+ * @param dst_capacity Output buffer size (must fit the original data)
+ * @return Decompressed size in bytes, or -1 on malformed input
+ */
+long korra_decompress(const void* src, size_t src_size, void* dst, size_t dst_capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // KORRA_COMPRESS_H
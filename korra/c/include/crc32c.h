@@ -0,0 +1,43 @@
+/**
+ * @file crc32c.h
+ * @brief Hardware-accelerated CRC32C (Castagnoli) for payload integrity
+ */
+
+#ifndef KORRA_CRC32C_H
+#define KORRA_CRC32C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * CRC32C of a buffer
+ *
+ * Dispatched at runtime to the SSE4.2 or ARMv8 CRC instructions when
+ * the CPU has them (near memory bandwidth), falling back to a table
+ * implementation otherwise.
+ *
+ * @param data Buffer to checksum
+ * @param size Buffer size in bytes
+ * @return CRC32C of the buffer (0 for an empty buffer)
+ */
+uint32_t korra_crc32c(const void* data, size_t size);
+
+/**
+ * Continue a CRC32C across split buffers
+ *
+ * @param crc CRC of the data seen so far (start with 0)
+ * @param data Next chunk
+ * @param size Chunk size in bytes
+ * @return Updated CRC
+ */
+uint32_t korra_crc32c_update(uint32_t crc, const void* data, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // KORRA_CRC32C_H
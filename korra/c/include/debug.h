@@ -7,77 +7,134 @@
 #define KORRA_DEBUG_H
 
 #include <stdio.h>
+#include <stddef.h>
 #include <time.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-// Debug log levels
+// Debug log levels. The preprocessor constants mirror the enum so the
+// macros below can be elided with #if — a site below the compile-time
+// threshold disappears entirely, format string included.
+#define KORRA_LOG_LEVEL_DEBUG 0
+#define KORRA_LOG_LEVEL_INFO  1
+#define KORRA_LOG_LEVEL_WARN  2
+#define KORRA_LOG_LEVEL_ERROR 3
+#define KORRA_LOG_LEVEL_FATAL 4
+
 typedef enum {
-    LOG_LEVEL_DEBUG,
-    LOG_LEVEL_INFO,
-    LOG_LEVEL_WARN,
-    LOG_LEVEL_ERROR,
-    LOG_LEVEL_FATAL
+    LOG_LEVEL_DEBUG = KORRA_LOG_LEVEL_DEBUG,
+    LOG_LEVEL_INFO = KORRA_LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN = KORRA_LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR = KORRA_LOG_LEVEL_ERROR,
+    LOG_LEVEL_FATAL = KORRA_LOG_LEVEL_FATAL
 } log_level_t;
 
-// Current log level (default: debug in development)
+// Compile-time log floor (default: debug in development). Override
+// with -DKORRA_LOG_COMPILE_LEVEL=KORRA_LOG_LEVEL_... to strip or keep
+// levels independently of NDEBUG.
+#ifndef KORRA_LOG_COMPILE_LEVEL
 #ifndef NDEBUG
-#define CURRENT_LOG_LEVEL LOG_LEVEL_DEBUG
+#define KORRA_LOG_COMPILE_LEVEL KORRA_LOG_LEVEL_DEBUG
 #else
-#define CURRENT_LOG_LEVEL LOG_LEVEL_INFO
+#define KORRA_LOG_COMPILE_LEVEL KORRA_LOG_LEVEL_INFO
+#endif
 #endif
 
+// Kept for translation units that still reference the old name
+#define CURRENT_LOG_LEVEL KORRA_LOG_COMPILE_LEVEL
+
+// Log modules, for runtime per-module filtering. A translation unit
+// picks its module by defining KORRA_LOG_MODULE before including this
+// header; unlabelled code falls into CORE.
+typedef enum {
+    KORRA_MODULE_CORE = 0,
+    KORRA_MODULE_NET,
+    KORRA_MODULE_INTEROP,
+    KORRA_MODULE_TOOLS,
+    KORRA_MODULE_COUNT
+} log_module_t;
+
+#ifndef KORRA_LOG_MODULE
+#define KORRA_LOG_MODULE KORRA_MODULE_CORE
+#endif
+
+// Runtime minimum level per module (defined in tools/log.c). A plain
+// byte read keeps the check to a load and compare on disabled sites.
+extern unsigned char korra_log_module_levels[KORRA_MODULE_COUNT];
+
+/**
+ * Set the runtime minimum log level for one module
+ *
+ * Lets production builds turn DEBUG on for, say, the net module
+ * without paying for it anywhere else (provided the sites survived
+ * KORRA_LOG_COMPILE_LEVEL).
+ *
+ * @param module Module to adjust
+ * @param level New minimum level for that module
+ */
+void korra_log_set_module_level(log_module_t module, log_level_t level);
+
+// Record sink implemented by the async backend in tools/log.c: a cheap
+// enqueue once korra_log_init() has run, a synchronous write before
+#ifdef __cplusplus
+void korra_log_write(log_level_t level, const char* file, int line, const char* fmt, ...);
+#else
+void korra_log_write(log_level_t level, const char* file, int line, const char* fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+#endif
+
+// True when the module's runtime mask admits `level`
+#define KORRA_LOG_ENABLED(level) \
+    ((level) >= korra_log_module_levels[KORRA_LOG_MODULE])
+
 // Debug log macro
+#if KORRA_LOG_COMPILE_LEVEL <= KORRA_LOG_LEVEL_DEBUG
 #define DEBUG_LOG(fmt, ...) do { \
-    if (CURRENT_LOG_LEVEL <= LOG_LEVEL_DEBUG) { \
-        time_t t = time(NULL); \
-        struct tm* tm_info = localtime(&t); \
-        char time_str[20]; \
-        strftime(time_str, 20, "%Y-%m-%d %H:%M:%S", tm_info); \
-        fprintf(stderr, "[%s][DEBUG][%s:%d] " fmt "\n", \
-                time_str, __FILE__, __LINE__, ##__VA_ARGS__); \
+    if (KORRA_LOG_ENABLED(LOG_LEVEL_DEBUG)) { \
+        korra_log_write(LOG_LEVEL_DEBUG, __FILE__, __LINE__, fmt, ##__VA_ARGS__); \
     } \
 } while (0)
+#else
+#define DEBUG_LOG(fmt, ...) do { } while (0)
+#endif
 
 // Info log macro
+#if KORRA_LOG_COMPILE_LEVEL <= KORRA_LOG_LEVEL_INFO
 #define INFO_LOG(fmt, ...) do { \
-    if (CURRENT_LOG_LEVEL <= LOG_LEVEL_INFO) { \
-        time_t t = time(NULL); \
-        struct tm* tm_info = localtime(&t); \
-        char time_str[20]; \
-        strftime(time_str, 20, "%Y-%m-%d %H:%M:%S", tm_info); \
-        fprintf(stderr, "[%s][INFO] " fmt "\n", \
-                time_str, ##__VA_ARGS__); \
+    if (KORRA_LOG_ENABLED(LOG_LEVEL_INFO)) { \
+        korra_log_write(LOG_LEVEL_INFO, NULL, 0, fmt, ##__VA_ARGS__); \
     } \
 } while (0)
+#else
+#define INFO_LOG(fmt, ...) do { } while (0)
+#endif
 
 // Warning log macro
+#if KORRA_LOG_COMPILE_LEVEL <= KORRA_LOG_LEVEL_WARN
 #define WARN_LOG(fmt, ...) do { \
-    if (CURRENT_LOG_LEVEL <= LOG_LEVEL_WARN) { \
-        time_t t = time(NULL); \
-        struct tm* tm_info = localtime(&t); \
-        char time_str[20]; \
-        strftime(time_str, 20, "%Y-%m-%d %H:%M:%S", tm_info); \
-        fprintf(stderr, "[%s][WARN][%s:%d] " fmt "\n", \
-                time_str, __FILE__, __LINE__, ##__VA_ARGS__); \
+    if (KORRA_LOG_ENABLED(LOG_LEVEL_WARN)) { \
+        korra_log_write(LOG_LEVEL_WARN, __FILE__, __LINE__, fmt, ##__VA_ARGS__); \
     } \
 } while (0)
+#else
+#define WARN_LOG(fmt, ...) do { } while (0)
+#endif
 
 // Error log macro
+#if KORRA_LOG_COMPILE_LEVEL <= KORRA_LOG_LEVEL_ERROR
 #define ERROR_LOG(fmt, ...) do { \
-    if (CURRENT_LOG_LEVEL <= LOG_LEVEL_ERROR) { \
-        time_t t = time(NULL); \
-        struct tm* tm_info = localtime(&t); \
-        char time_str[20]; \
-        strftime(time_str, 20, "%Y-%m-%d %H:%M:%S", tm_info); \
-        fprintf(stderr, "[%s][ERROR][%s:%d] " fmt "\n", \
-                time_str, __FILE__, __LINE__, ##__VA_ARGS__); \
+    if (KORRA_LOG_ENABLED(LOG_LEVEL_ERROR)) { \
+        korra_log_write(LOG_LEVEL_ERROR, __FILE__, __LINE__, fmt, ##__VA_ARGS__); \
     } \
 } while (0)
+#else
+#define ERROR_LOG(fmt, ...) do { } while (0)
+#endif
 
-// Fatal log macro
+// Fatal log macro. Deliberately synchronous: the process is about to
+// exit, so the record must not sit in an async ring.
 #define FATAL_LOG(fmt, ...) do { \
     if (CURRENT_LOG_LEVEL <= LOG_LEVEL_FATAL) { \
         time_t t = time(NULL); \
@@ -90,6 +147,65 @@ typedef enum {
     exit(1); \
 } while (0)
 
+/**
+ * Initialize debug and crash handling
+ */
+void debug_init();
+
+/**
+ * Dump the current process memory map to stderr
+ */
+void debug_dump_memmap();
+
+/**
+ * Set the current thread name for debugging
+ *
+ * @param name Thread name (truncated to 15 characters on Linux)
+ */
+void debug_set_thread_name(const char* name);
+
+/**
+ * Dump a hex representation of a memory region to stderr
+ *
+ * @param data Start of the region
+ * @param size Number of bytes to dump
+ */
+void debug_hexdump(const void* data, size_t size);
+
+// Async-signal-safe output helpers, for code that runs inside signal
+// handlers (the crash path). write()-only: no stdio, no locks, no
+// allocation.
+
+/**
+ * Write a string with write(), safe inside a signal handler
+ *
+ * @param fd Destination file descriptor
+ * @param str NUL-terminated string
+ */
+void debug_write_str(int fd, const char* str);
+
+/**
+ * Write a decimal number with write(), safe inside a signal handler
+ *
+ * @param fd Destination file descriptor
+ * @param value Value to print
+ */
+void debug_write_dec(int fd, long long value);
+
+// A crash dumper writes one subsystem's state to `fd` using only
+// async-signal-safe calls (the debug_write_* helpers)
+typedef void (*debug_crash_dumper_t)(int fd);
+
+/**
+ * Register a subsystem dumper to run inside the crash handler
+ *
+ * Dumpers run in registration order after the stack trace. Registering
+ * the same function twice is a no-op.
+ *
+ * @param dumper Function to call with the crash output fd
+ */
+void debug_register_crash_dumper(debug_crash_dumper_t dumper);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,69 @@
+/**
+ * @file event_loop.h
+ * @brief Multi-connection epoll event loop for the KORRA transport
+ */
+
+#ifndef KORRA_EVENT_LOOP_H
+#define KORRA_EVENT_LOOP_H
+
+#include "transport.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Handler invoked from a pool worker for every complete message
+ * received on a connection. The handler owns the payload and must
+ * release it with transport_message_free() (or keep a reference via
+ * korra_buf_ref). When the peer closes the connection or a receive fails, the
+ * handler is called once with message == NULL after the fd has been
+ * closed, so callers can drop per-connection state.
+ */
+typedef void (*event_message_handler_t)(int fd, transport_message_t* message);
+
+/**
+ * Initialize the event loop
+ *
+ * @param handler Message handler invoked from pool workers
+ * @return 0 on success, -1 on failure
+ */
+int event_loop_init(event_message_handler_t handler);
+
+/**
+ * Register a connection with the event loop
+ *
+ * @param fd Connected socket file descriptor
+ * @return 0 on success, -1 on failure
+ */
+int event_loop_add_connection(int fd);
+
+/**
+ * Remove a connection from the event loop and close it
+ *
+ * @param fd Connection file descriptor
+ * @return 0 on success, -1 on failure
+ */
+int event_loop_remove_connection(int fd);
+
+/**
+ * Run the event loop on the calling thread
+ *
+ * Accepts new connections on the transport listening socket (if this
+ * node is a server) and dispatches readable connections into the
+ * thread pool. Blocks until event_loop_stop() is called.
+ *
+ * @return 0 on clean stop, -1 on failure
+ */
+int event_loop_run(void);
+
+/**
+ * Stop a running event loop
+ */
+void event_loop_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // KORRA_EVENT_LOOP_H
@@ -0,0 +1,48 @@
+/**
+ * @file log.h
+ * @brief Asynchronous logging backend for KORRA
+ */
+
+#ifndef KORRA_LOG_H
+#define KORRA_LOG_H
+
+#include "debug.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Start the asynchronous logging backend
+ *
+ * After this, the logging macros in debug.h enqueue records into
+ * per-thread lock-free rings and a dedicated drain thread does the
+ * timestamp formatting and stderr I/O. Before init (and after
+ * shutdown) the macros log synchronously, so early-boot and test code
+ * needs no setup.
+ *
+ * @return 0 on success, -1 on failure
+ */
+int korra_log_init(void);
+
+/**
+ * Flush outstanding records and stop the drain thread
+ */
+void korra_log_shutdown(void);
+
+/**
+ * Emit one log record (used by the debug.h macros; not called directly)
+ *
+ * @param level Log level
+ * @param file Source file, or NULL to omit the file:line tag
+ * @param line Source line
+ * @param fmt printf-style format string
+ */
+void korra_log_write(log_level_t level, const char* file, int line, const char* fmt, ...)
+    __attribute__((format(printf, 4, 5)));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // KORRA_LOG_H
@@ -0,0 +1,70 @@
+/**
+ * @file profiler.h
+ * @brief In-process sampling profiler with task-name attribution
+ */
+
+#ifndef KORRA_PROFILER_H
+#define KORRA_PROFILER_H
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Register the calling thread for sampling
+ *
+ * Worker threads call this once at startup; unregistered threads are
+ * never signalled by the sampler.
+ *
+ * @return 0 on success, -1 when the slot table is full
+ */
+int korra_profiler_thread_register(void);
+
+/**
+ * Publish the task the calling thread is running
+ *
+ * A couple of atomic bumps and a name copy, cheap enough to wrap every
+ * task. Pass NULL when the task finishes.
+ *
+ * @param name Task name, or NULL for idle
+ */
+void korra_profiler_set_task(const char* name);
+
+/**
+ * Start the sampler thread
+ *
+ * Periodically interrupts each registered thread with SIGPROF; the
+ * handler records the running task name and a backtrace() of the
+ * thread's stack, and samples are folded into an in-memory table.
+ *
+ * @param interval_ms Sampling period in milliseconds (<= 0 means 10)
+ * @return 0 on success, -1 on failure
+ */
+int korra_profiler_start(int interval_ms);
+
+/**
+ * Stop the sampler thread; accumulated samples are kept
+ */
+void korra_profiler_stop(void);
+
+/**
+ * Write accumulated samples in folded flame-graph form
+ *
+ * One line per unique (task name, stack) pair:
+ *
+ *   task-name;outer_frame;...;inner_frame count
+ *
+ * ready for flamegraph.pl or speedscope. Also resets the table.
+ *
+ * @param out Stream to write to
+ * @return Number of unique stacks written, or -1 on failure
+ */
+int korra_profiler_dump(FILE* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // KORRA_PROFILER_H
@@ -7,6 +7,7 @@
 #define KORRA_RUST_GLUE_H
 
 #include <stddef.h>
+#include "bufpool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -18,12 +19,17 @@ typedef void* agent_handle_t;
 // Function types for Rust callbacks
 typedef agent_handle_t (*rust_agent_create_fn)(const char*, const char*);
 typedef int (*rust_agent_execute_fn)(agent_handle_t, const void*, size_t, void**, size_t*);
+typedef int (*rust_agent_execute_batch_fn)(agent_handle_t, const void**, const size_t*, int,
+                                           void**, size_t*);
 typedef void (*rust_agent_destroy_fn)(agent_handle_t);
 
-// Struct containing Rust callback functions
+// Struct containing Rust callback functions. agent_execute_batch is
+// optional; when NULL, batched execution falls back to one crossing
+// per input.
 typedef struct {
     rust_agent_create_fn agent_create;
     rust_agent_execute_fn agent_execute;
+    rust_agent_execute_batch_fn agent_execute_batch;
     rust_agent_destroy_fn agent_destroy;
 } rust_ffi_callbacks_t;
 
@@ -57,13 +63,72 @@ agent_handle_t create_agent(const char* agent_type, const char* config);
 int execute_agent(agent_handle_t handle, const void* input, size_t input_size,
                   void** output, size_t* output_size);
 
+/**
+ * Execute an agent against a pooled buffer, zero-copy end to end
+ *
+ * The input is consumed in place (typically the buffer a
+ * transport_message_t arrived in), and large outputs the agent
+ * allocates come back as the pooled buffer they were written into, so
+ * a multi-megabyte result can go straight to transport_send_fd()
+ * without a memcpy. The caller releases the output with
+ * korra_buf_release() when done; the input buffer is not consumed.
+ *
+ * @param handle Agent handle
+ * @param input Buffer holding the input payload
+ * @param input_size Bytes of input in the buffer
+ * @param output Set to a buffer holding the output (caller releases)
+ * @param output_size Set to the output size in bytes
+ * @return 0 on success, -1 on failure
+ */
+int execute_agent_buf(agent_handle_t handle, korra_buf_t* input, size_t input_size,
+                      korra_buf_t** output, size_t* output_size);
+
+/**
+ * Execute an agent on a batch of homogeneous inputs
+ *
+ * Crosses the FFI once for the whole batch when the Rust side
+ * registered agent_execute_batch, letting it amortize dispatch and
+ * vectorize; otherwise falls back to per-input crossings. Outputs are
+ * filled per input; a failed input leaves its output NULL.
+ *
+ * @param handle Agent handle
+ * @param inputs Array of input pointers
+ * @param input_sizes Array of input sizes
+ * @param count Number of inputs
+ * @param outputs Array to fill with output pointers (caller must free)
+ * @param output_sizes Array to fill with output sizes
+ * @return Number of inputs executed successfully, or -1 on failure
+ */
+int execute_agent_batch(agent_handle_t handle, const void** inputs, const size_t* input_sizes,
+                        int count, void** outputs, size_t* output_sizes);
+
 /**
  * Destroy an agent instance
- * 
+ *
+ * Identically configured agents are parked in a warm pool instead of
+ * being destroyed, so the next create_agent() with the same
+ * (type, config) pair is served without crossing into Rust.
+ *
  * @param handle Agent handle
  */
 void destroy_agent(agent_handle_t handle);
 
+/**
+ * Evict all warm-pooled agents, destroying them for real
+ */
+void agent_cache_flush(void);
+
+/**
+ * Write the known (type, config) pairs to a warm-state file
+ *
+ * One agent per line, type and config separated by a tab - the format
+ * korra_warmstart_begin() pre-creates agents from on the next boot.
+ *
+ * @param path File to write
+ * @return Number of pairs saved, or -1 on failure
+ */
+int agent_cache_save(const char* path);
+
 /**
  * C callback for Rust to call for logging
  * 
@@ -0,0 +1,85 @@
+/**
+ * @file sendq.h
+ * @brief Per-connection outbound queue with an mmap-backed spill journal
+ */
+
+#ifndef KORRA_SENDQ_H
+#define KORRA_SENDQ_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Open an outbound queue for a connection
+ *
+ * Appends land in an in-memory ring; when the ring fills (slow
+ * consumer) records spill to a memory-mapped journal file, which also
+ * serves as the replay log after a reconnect. A single drain thread
+ * (started with the first queue) writes records to the socket as it
+ * accepts them, so producers never block on a stalled peer.
+ *
+ * @param fd Connection file descriptor
+ * @param journal_path Path for the spill journal file
+ * @return 0 on success, -1 on failure
+ */
+int korra_sendq_open(int fd, const char* journal_path);
+
+/**
+ * Queue one complete wire frame for sending
+ *
+ * Never blocks: the frame is copied into the ring or spilled to the
+ * journal and the drain thread writes it out when the socket accepts
+ * data.
+ *
+ * @param fd Connection file descriptor with an open queue
+ * @param frame Complete wire frame (header plus payload)
+ * @param size Frame size in bytes
+ * @return 0 on success, -1 if the queue is not open or the journal
+ *         is full
+ */
+int korra_sendq_append(int fd, const void* frame, size_t size);
+
+/**
+ * Re-point a queue at a new socket after reconnecting
+ *
+ * Undelivered records - including everything parked in the journal
+ * while the old connection was dead - are replayed to the new socket
+ * from the last record boundary, so the peer does not need a full
+ * state resync.
+ *
+ * @param old_fd File descriptor the queue was opened with
+ * @param new_fd Reconnected file descriptor
+ * @return 0 on success, -1 if no queue is open for old_fd
+ */
+int korra_sendq_reattach(int old_fd, int new_fd);
+
+/**
+ * Number of records still queued for a connection
+ *
+ * @param fd Connection file descriptor
+ * @return Queued record count, or -1 if no queue is open
+ */
+int korra_sendq_pending(int fd);
+
+/**
+ * Close a connection's queue and delete its journal
+ *
+ * Undelivered records are dropped.
+ *
+ * @param fd Connection file descriptor
+ */
+void korra_sendq_close(int fd);
+
+/**
+ * Stop the drain thread and close every queue
+ */
+void korra_sendq_shutdown(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // KORRA_SENDQ_H
@@ -0,0 +1,136 @@
+/**
+ * @file stats.h
+ * @brief Hot-path counters and latency histograms for KORRA
+ */
+
+#ifndef KORRA_STATS_H
+#define KORRA_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Event counters. Each is a per-thread relaxed atomic add on a
+// cache-line-padded block, a few ns per event.
+typedef enum {
+    KORRA_CTR_TASKS_SUBMITTED = 0,
+    KORRA_CTR_TASKS_EXECUTED,
+    KORRA_CTR_MSGS_SENT,
+    KORRA_CTR_BYTES_SENT,
+    KORRA_CTR_MSGS_RECEIVED,
+    KORRA_CTR_BYTES_RECEIVED,
+    KORRA_CTR_AGENT_EXECUTIONS,
+    KORRA_CTR_TASKS_SHED,
+    KORRA_CTR_COUNT
+} korra_counter_t;
+
+// Latency histograms. Buckets are powers of two in microseconds:
+// bucket 0 is <1us, bucket i covers [2^(i-1), 2^i) us.
+typedef enum {
+    KORRA_HIST_QUEUE_WAIT_US = 0,   // submit to start of execution
+    KORRA_HIST_TASK_RUN_US,         // task function runtime
+    KORRA_HIST_FFI_EXEC_US,         // execute_agent() crossing latency
+    KORRA_HIST_COUNT
+} korra_histogram_t;
+
+// Histogram buckets: top bucket covers everything >= ~33s
+#define KORRA_STATS_BUCKETS 26
+
+// Per-message-type counter slots (msg_type is a uint8_t on the wire)
+#define KORRA_STATS_MSG_TYPES 256
+
+// Distinct task names tracked per thread; overflow lands in a
+// catch-all slot named "other"
+#define KORRA_STATS_TASK_NAMES 32
+
+// Per-task-name aggregate in a snapshot
+typedef struct {
+    char name[64];
+    uint64_t count;
+    uint64_t total_us;
+} korra_task_stat_t;
+
+// Aggregated view across all threads, taken without stopping writers
+typedef struct {
+    uint64_t counters[KORRA_CTR_COUNT];
+    uint64_t histograms[KORRA_HIST_COUNT][KORRA_STATS_BUCKETS];
+    uint64_t sent_by_type[KORRA_STATS_MSG_TYPES];
+    uint64_t received_by_type[KORRA_STATS_MSG_TYPES];
+    korra_task_stat_t tasks[KORRA_STATS_TASK_NAMES];
+    int num_tasks;
+} korra_stats_snapshot_t;
+
+/**
+ * Add to an event counter
+ *
+ * @param counter Counter to bump
+ * @param delta Amount to add
+ */
+void korra_stats_count(korra_counter_t counter, uint64_t delta);
+
+/**
+ * Record a latency sample
+ *
+ * @param histogram Histogram to record into
+ * @param us Sample in microseconds
+ */
+void korra_stats_record(korra_histogram_t histogram, uint64_t us);
+
+/**
+ * Record a sent message: message count, byte count and per-type count
+ *
+ * @param msg_type Wire message type
+ * @param bytes Payload bytes sent
+ */
+void korra_stats_message_sent(uint8_t msg_type, size_t bytes);
+
+/**
+ * Record a received message: message count, byte count and per-type count
+ *
+ * @param msg_type Wire message type
+ * @param bytes Payload bytes received
+ */
+void korra_stats_message_received(uint8_t msg_type, size_t bytes);
+
+/**
+ * Record one execution of a named task
+ *
+ * @param name Task name
+ * @param run_us Task runtime in microseconds
+ */
+void korra_stats_task_run(const char* name, uint64_t run_us);
+
+/**
+ * Monotonic clock in microseconds, for bracketing hot-path events
+ *
+ * @return Current CLOCK_MONOTONIC time in microseconds
+ */
+uint64_t korra_stats_now_us(void);
+
+/**
+ * Aggregate all threads' stats into a snapshot
+ *
+ * Readers sum relaxed atomics; writers are never blocked or slowed.
+ * Counters may be mid-update, so a snapshot is consistent to within
+ * the events in flight while it was taken.
+ *
+ * @param out Snapshot to fill
+ */
+void korra_stats_snapshot(korra_stats_snapshot_t* out);
+
+/**
+ * Lower bound of a histogram bucket
+ *
+ * @param bucket Bucket index
+ * @return Smallest microsecond value counted in that bucket
+ */
+uint64_t korra_stats_bucket_floor_us(int bucket);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // KORRA_STATS_H
@@ -6,6 +6,9 @@
 #ifndef KORRA_THREAD_H
 #define KORRA_THREAD_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -13,19 +16,41 @@ extern "C" {
 // Task function type
 typedef void (*task_function_t)(void*);
 
+// Task priority classes. NORMAL is 0 so zero-initialized tasks keep
+// today's behavior; HIGH is for latency-critical control-plane work
+// (heartbeats, job results), LOW for background processing like state
+// sync application.
+typedef enum {
+    TASK_PRIORITY_NORMAL = 0,
+    TASK_PRIORITY_HIGH = 1,
+    TASK_PRIORITY_LOW = 2,
+    TASK_PRIORITY_COUNT = 3
+} task_priority_t;
+
 // Task structure
 typedef struct {
     char name[64];
     task_function_t function;
     void* arg;
+    task_priority_t priority;
+    uint64_t deadline_us;   // Optional deadline relative to submit; 0 = none
+    uint64_t submit_us;     // Stamped at submit; feeds queue-wait stats
 } thread_task_t;
 
+// Thread pool configuration
+typedef struct {
+    int num_threads;    // Number of workers; <= 0 means one per online CPU
+    bool pin_workers;   // Pin worker i to CPU i (modulo online CPUs)
+} thread_pool_config_t;
+
 /**
  * Initialize the thread pool
- * 
+ *
+ * @param config Pool configuration, or NULL for defaults
+ *               (one worker per online CPU, no pinning)
  * @return 0 on success, -1 on failure
  */
-int thread_pool_init();
+int thread_pool_init(const thread_pool_config_t* config);
 
 /**
  * Submit a task to the thread pool
@@ -35,6 +60,180 @@ int thread_pool_init();
  */
 int thread_pool_submit(thread_task_t task);
 
+// Called for each task rejected by thread_pool_try_submit(), from the
+// submitting thread, so the producer can drop, defer, or log the work
+typedef void (*thread_shed_callback_t)(const thread_task_t* task, void* ctx);
+
+// Backpressure policy. A priority class is shed once its share of the
+// pool's ring capacity passes its threshold, so low-value work backs
+// off early while control traffic keeps flowing; zero thresholds keep
+// the defaults (HIGH 100%, NORMAL 85%, LOW 60%).
+typedef struct {
+    int max_occupancy_pct[TASK_PRIORITY_COUNT];
+    thread_shed_callback_t shed_callback;   // NULL = silent rejection
+    void* shed_ctx;                         // Opaque pointer for the callback
+} thread_pool_backpressure_t;
+
+/**
+ * Install the backpressure policy used by thread_pool_try_submit()
+ *
+ * @param config Policy to install, or NULL to restore defaults
+ * @return 0 on success
+ */
+int thread_pool_set_backpressure(const thread_pool_backpressure_t* config);
+
+/**
+ * Submit a task without ever blocking the producer
+ *
+ * Unlike thread_pool_submit(), which parks on a condvar when every
+ * ring is full, this sheds the task - shed callback, then -1 - when
+ * its priority class is over its occupancy threshold or no ring has
+ * room. Use it on paths that must keep draining under overload
+ * (transport receive), with HIGH priority for work that must always
+ * be accepted (heartbeats).
+ *
+ * @param task The task to submit
+ * @return 0 on success, -1 if the task was shed
+ */
+int thread_pool_try_submit(thread_task_t task);
+
+/**
+ * Submit a task with affinity for a NUMA node
+ *
+ * Prefers workers grouped on `node` (see topology.h), so a task lands
+ * on the socket whose memory holds its payload - pass
+ * korra_topology_current_node() from the thread that received or
+ * allocated the data. Falls back to any worker when the node's rings
+ * are full. Affinity is advisory unless workers are pinned.
+ *
+ * @param task The task to submit
+ * @param node Preferred NUMA node
+ * @return 0 on success, -1 on failure
+ */
+int thread_pool_submit_on_node(thread_task_t task, int node);
+
+/**
+ * Submit a task that runs once after a delay
+ *
+ * The task is parked on a hashed timer wheel and enqueued onto the
+ * pool when the delay expires, replacing dedicated sleep-loop threads
+ * for deferred work. Expiry accuracy is one wheel tick (0.5ms) plus
+ * scheduler wakeup latency.
+ *
+ * @param task The task to submit
+ * @param delay_us Delay before the task is enqueued, in microseconds
+ * @return 0 on success, -1 on failure
+ */
+int thread_pool_submit_delayed(thread_task_t task, uint64_t delay_us);
+
+/**
+ * Submit a task that runs repeatedly at a fixed period
+ *
+ * The first run happens after `delay_us`, then every `period_us`.
+ * Periods are measured expiry to expiry, so a slow task run does not
+ * stretch the schedule. The timer keeps firing until cancelled or the
+ * pool shuts down.
+ *
+ * @param task The task to submit on each expiry
+ * @param delay_us Delay before the first run, in microseconds
+ * @param period_us Interval between runs, in microseconds (must be > 0)
+ * @return Timer id (>= 0) for thread_pool_cancel_timer, -1 on failure
+ */
+int thread_pool_submit_periodic(thread_task_t task, uint64_t delay_us,
+                                uint64_t period_us);
+
+/**
+ * Cancel a pending delayed or periodic timer
+ *
+ * A run already handed to the pool still executes; no further runs
+ * are scheduled.
+ *
+ * @param timer_id Id returned by thread_pool_submit_periodic
+ * @return 0 on success, -1 if the timer is not armed
+ */
+int thread_pool_cancel_timer(int timer_id);
+
+/**
+ * Submit a batch of tasks to the thread pool
+ *
+ * Enqueues the whole array under one synchronization episode, waking
+ * sleeping workers once at the end instead of once per task.
+ *
+ * @param tasks Array of tasks to submit
+ * @param count Number of tasks in the array
+ * @return Number of tasks submitted, or -1 on failure
+ */
+int thread_pool_submit_batch(thread_task_t* tasks, int count);
+
+// Completion handle linking an async operation to follow-up tasks.
+// Instead of a worker blocking mid-task on an FFI result or a socket
+// write, the task registers a continuation on a completion and
+// returns; whoever finishes the async work fires the completion and
+// the continuation is enqueued like any other task.
+typedef struct thread_completion thread_completion_t;
+
+/**
+ * Create a completion handle
+ *
+ * The handle starts with one reference; take another with
+ * thread_completion_ref() before handing it to the async producer so
+ * either side can release first.
+ *
+ * @return New completion, or NULL on allocation failure
+ */
+thread_completion_t* thread_completion_create(void);
+
+/**
+ * Take an additional reference on a completion
+ *
+ * @param completion Completion handle
+ */
+void thread_completion_ref(thread_completion_t* completion);
+
+/**
+ * Drop a reference; the completion is freed when the last one goes
+ *
+ * @param completion Completion handle, NULL is ignored
+ */
+void thread_completion_release(thread_completion_t* completion);
+
+/**
+ * Register a follow-up task on a completion
+ *
+ * The task is submitted to the pool when the completion fires; if it
+ * already fired, the task is submitted immediately. Tasks run with
+ * their own priority and can themselves register continuations,
+ * chaining a blocking pipeline into event-driven stages.
+ *
+ * @param completion Completion handle
+ * @param task Task to run once the completion fires
+ * @return 0 on success, -1 on failure
+ */
+int thread_completion_then(thread_completion_t* completion, thread_task_t task);
+
+/**
+ * Fire a completion, submitting every registered follow-up task
+ *
+ * One-shot: later calls are ignored. Safe to call from any thread,
+ * including FFI callbacks and the event loop.
+ *
+ * @param completion Completion handle
+ * @param result Value handed to continuations via
+ *               thread_completion_result(); may be NULL
+ * @return Number of tasks submitted, or -1 on failure
+ */
+int thread_completion_fire(thread_completion_t* completion, void* result);
+
+/**
+ * Read the result a completion was fired with
+ *
+ * Valid only inside a continuation (or any time after the fire).
+ *
+ * @param completion Completion handle
+ * @return The result pointer passed to thread_completion_fire()
+ */
+void* thread_completion_result(thread_completion_t* completion);
+
 /**
  * Shutdown the thread pool
  * 
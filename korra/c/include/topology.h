@@ -0,0 +1,45 @@
+/**
+ * @file topology.h
+ * @brief CPU/NUMA topology discovery for KORRA
+ */
+
+#ifndef KORRA_TOPOLOGY_H
+#define KORRA_TOPOLOGY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Number of NUMA nodes on this machine
+ *
+ * Read once from sysfs; machines without exposed NUMA topology report
+ * a single node.
+ *
+ * @return Node count, at least 1
+ */
+int korra_topology_num_nodes(void);
+
+/**
+ * NUMA node a CPU belongs to
+ *
+ * @param cpu CPU index
+ * @return Node index, 0 if unknown
+ */
+int korra_topology_node_of_cpu(int cpu);
+
+/**
+ * NUMA node the calling thread is currently running on
+ *
+ * Cheap (vDSO sched_getcpu), so it is fine to call per allocation.
+ * Only stable for threads pinned to a CPU or node.
+ *
+ * @return Node index, 0 if unknown
+ */
+int korra_topology_current_node(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // KORRA_TOPOLOGY_H
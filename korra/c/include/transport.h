@@ -8,13 +8,37 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "bufpool.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-// Protocol version
-#define KORRA_PROTOCOL_VERSION 1
+// Protocol version. Version 2 added the payload checksum field to the
+// header; peers on version 1 are rejected.
+#define KORRA_PROTOCOL_VERSION 2
+
+// The header's reserved field: flag bits in the low byte, the frame's
+// mux channel id in the high byte (0 = default channel)
+#define TRANSPORT_FLAG_COMPRESSED 0x0001    // Payload is LZ-compressed
+#define TRANSPORT_FLAG_STREAM_BEGIN 0x0002  // Opens a chunked stream (payload: uint64 total size)
+#define TRANSPORT_FLAG_STREAM_CHUNK 0x0004  // One chunk of stream data
+#define TRANSPORT_FLAG_STREAM_END 0x0008    // Set on the final chunk
+#define TRANSPORT_CHANNEL_SHIFT 8           // Channel id position in reserved
+
+// Logical channels multiplexed per connection
+#define TRANSPORT_MUX_CHANNELS 16
+
+// Bytes one channel may send per scheduling round at weight 1
+#define TRANSPORT_MUX_QUANTUM 65536
+
+// Chunk size for streamed payloads: one pool size class, so a
+// multi-gigabyte sync flows through recycled fixed-size buffers
+#define TRANSPORT_STREAM_CHUNK_SIZE 65536
+
+// Return codes beyond the usual 0 / -1
+#define TRANSPORT_CLOSED (-2)       // Peer closed the connection
+#define TRANSPORT_WOULDBLOCK (-3)   // Frame incomplete on a non-blocking socket
 
 // Message types
 typedef enum {
@@ -33,15 +57,18 @@ typedef struct {
     uint32_t magic;         // Magic number to identify KORRA messages
     uint8_t version;        // Protocol version
     uint8_t msg_type;       // Message type
-    uint16_t reserved;      // Reserved for future use
+    uint16_t reserved;      // TRANSPORT_FLAG_* bits
     uint32_t payload_size;  // Size of payload in bytes
+    uint32_t checksum;      // CRC32C of the payload as sent on the wire
 } transport_header_t;
 
 // Message structure
 typedef struct {
     uint8_t msg_type;       // Message type
+    uint8_t channel;        // Mux channel the frame arrived on, 0 if none
     uint32_t payload_size;  // Size of payload in bytes
     void* payload;          // Payload data
+    korra_buf_t* buffer;    // Pool buffer backing payload, NULL if none
 } transport_message_t;
 
 /**
@@ -61,6 +88,25 @@ int transport_init(int port, bool is_server);
  */
 int transport_send(const transport_message_t* message);
 
+/**
+ * Send a batch of messages coalesced into as few syscalls as possible
+ *
+ * @param messages Array of messages to send
+ * @param count Number of messages in the array
+ * @return 0 on success, -1 on failure
+ */
+int transport_send_batch(const transport_message_t* messages, int count);
+
+/**
+ * Send a batch of messages on a specific connection
+ *
+ * @param fd Connection file descriptor
+ * @param messages Array of messages to send
+ * @param count Number of messages in the array
+ * @return 0 on success, -1 on failure
+ */
+int transport_send_batch_fd(int fd, const transport_message_t* messages, int count);
+
 /**
  * Receive a message
  * 
@@ -69,6 +115,181 @@ int transport_send(const transport_message_t* message);
  */
 int transport_receive(transport_message_t* message);
 
+/**
+ * Send a message on a specific connection
+ *
+ * @param fd Connection file descriptor
+ * @param message Message to send
+ * @return 0 on success, -1 on failure
+ */
+int transport_send_fd(int fd, const transport_message_t* message);
+
+/**
+ * Queue a message on a connection's outbound send queue
+ *
+ * The message is framed and handed to the queue opened with
+ * korra_sendq_open(); this never blocks on the socket. Ordering with
+ * direct transport_send_fd() calls on the same connection is not
+ * defined - route all of a connection's traffic through one path.
+ *
+ * @param fd Connection file descriptor with an open send queue
+ * @param message Message to send
+ * @return 0 on success, -1 if the queue is not open or full
+ */
+int transport_send_queued_fd(int fd, const transport_message_t* message);
+
+/**
+ * Receive a message from a specific connection
+ *
+ * Bytes are accumulated across recv() calls, so frames split by TCP
+ * segmentation are reassembled instead of treated as errors. On a
+ * non-blocking socket an incomplete frame yields TRANSPORT_WOULDBLOCK
+ * and the partial state is kept until the next call for that fd.
+ *
+ * @param fd Connection file descriptor
+ * @param message Message structure to fill
+ * @return 0 on success, -1 on failure, TRANSPORT_CLOSED if the peer
+ *         closed the connection, TRANSPORT_WOULDBLOCK if the frame is
+ *         not complete yet
+ */
+int transport_receive_fd(int fd, transport_message_t* message);
+
+/**
+ * Queue a message on a mux channel of a connection
+ *
+ * Channels share one TCP link fairly: frames are parked per channel
+ * and transport_mux_flush_fd() interleaves them with deficit
+ * round-robin, so a bulk flow on one channel cannot monopolize the
+ * link ahead of 49 others' job results. Channel 0 is the default for
+ * unclassified traffic; the receiver sees the channel id on each
+ * message. Frames are not compressed on this path.
+ *
+ * @param fd Connection file descriptor
+ * @param channel Channel id (0 to TRANSPORT_MUX_CHANNELS - 1)
+ * @param message Message to queue
+ * @return 0 on success, -1 on failure
+ */
+int transport_mux_send_fd(int fd, uint8_t channel, const transport_message_t* message);
+
+/**
+ * Set a channel's scheduling weight
+ *
+ * A channel sends up to weight * TRANSPORT_MUX_QUANTUM bytes per
+ * round, so weight 4 gets ~4x the bandwidth of weight 1 under
+ * contention. Default weight is 1.
+ *
+ * @param fd Connection file descriptor
+ * @param channel Channel id
+ * @param weight Relative weight, clamped to 1..64
+ */
+void transport_mux_set_weight(int fd, uint8_t channel, int weight);
+
+/**
+ * Write queued mux frames to the socket until all channels drain
+ *
+ * Runs the deficit round-robin scheduler: each round every backlogged
+ * channel earns its quantum and sends whole frames while its deficit
+ * covers them, so small-channel frames interleave between a bulk
+ * channel's. Call after queueing a burst, or per event-loop writable
+ * notification.
+ *
+ * @param fd Connection file descriptor
+ * @return 0 on success, -1 on a socket error (queued frames kept)
+ */
+int transport_mux_flush_fd(int fd);
+
+/**
+ * Drop a connection's queued mux frames and scheduling state
+ *
+ * Call when the connection closes so a later connection reusing the
+ * fd does not inherit stale traffic.
+ *
+ * @param fd Connection file descriptor
+ */
+void transport_mux_reset_fd(int fd);
+
+// Feeds outbound stream data chunk by chunk. Fill `chunk` with up to
+// `capacity` bytes and return the count; 0 means end of stream, -1
+// aborts the send.
+typedef long (*transport_stream_reader_t)(void* ctx, void* chunk, size_t capacity);
+
+// Receives inbound stream data chunk by chunk, in order. `offset` is
+// the chunk's position in the stream, `last` marks the final chunk.
+// Return 0 to continue, -1 to abort the stream.
+typedef int (*transport_stream_handler_t)(uint8_t msg_type, uint64_t offset,
+                                          uint64_t total_size, const void* chunk,
+                                          size_t chunk_size, bool last, void* ctx);
+
+/**
+ * Send a payload as a chunked stream
+ *
+ * Frames the data as a begin/chunk/end sequence of
+ * TRANSPORT_STREAM_CHUNK_SIZE pieces pulled from `reader`, so neither
+ * side ever holds more than one chunk in memory and control messages
+ * can be interleaved between chunks on the same connection.
+ *
+ * @param fd Connection file descriptor
+ * @param msg_type Message type delivered to the receive handler
+ * @param total_size Total stream size in bytes
+ * @param reader Callback producing the next chunk of data
+ * @param ctx Opaque pointer passed to the reader
+ * @return 0 on success, -1 on failure
+ */
+int transport_send_stream_fd(int fd, uint8_t msg_type, uint64_t total_size,
+                             transport_stream_reader_t reader, void* ctx);
+
+/**
+ * Install the handler for inbound chunked streams
+ *
+ * Stream frames are consumed inside transport_receive_fd() and never
+ * surface as messages; the handler sees each chunk from a recycled
+ * pool buffer. Inbound streams are dropped when no handler is set.
+ *
+ * @param handler Chunk callback, or NULL to clear
+ * @param ctx Opaque pointer passed to the handler
+ */
+void transport_set_stream_handler(transport_stream_handler_t handler, void* ctx);
+
+/**
+ * Enable or disable outbound payload compression
+ *
+ * When enabled, payloads above an internal size threshold are
+ * compressed in transport_send() and flagged in the header;
+ * transport_receive() decompresses flagged payloads transparently
+ * regardless of this setting.
+ *
+ * @param enable Whether to compress large outbound payloads
+ */
+void transport_set_compression(bool enable);
+
+/**
+ * Release a received message's payload
+ *
+ * Drops the pool-buffer reference when the payload is pooled, frees it
+ * otherwise. Safe to call on messages with no payload.
+ *
+ * @param message Message whose payload should be released
+ */
+void transport_message_free(transport_message_t* message);
+
+/**
+ * Get the listening socket file descriptor (server only)
+ *
+ * @return Listening socket fd, or -1 if not a server
+ */
+int transport_listen_fd(void);
+
+/**
+ * Get the UDP fast-path socket file descriptor
+ *
+ * Heartbeats and small control messages ride this datagram socket
+ * (same header framing) so bulk transfers on the TCP stream can't
+ * delay them; poll it alongside the stream socket.
+ *
+ * @return UDP socket fd, or -1 if the fast path is unavailable
+ */
+int transport_udp_fd(void);
+
 /**
  * Accept an incoming connection (server only)
  * 
@@ -0,0 +1,62 @@
+/**
+ * @file warmstart.h
+ * @brief Parallel boot and agent pre-warming for KORRA
+ */
+
+#ifndef KORRA_WARMSTART_H
+#define KORRA_WARMSTART_H
+
+#include <stdbool.h>
+#include "thread.h"
+#include "rust_glue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Everything korra_warmstart_begin() needs to bring a node up
+typedef struct {
+    const thread_pool_config_t* pool;   // Pool config, NULL for defaults
+    int port;                           // Transport port
+    bool is_server;                     // Transport role
+    rust_ffi_callbacks_t callbacks;     // Rust FFI callbacks
+    const char* warm_state_path;        // Warm-state file, NULL to skip
+} korra_warmstart_config_t;
+
+/**
+ * Bring all subsystems up in parallel and start agent pre-warming
+ *
+ * thread_pool_init(), transport_init() and rust_ffi_init() run
+ * concurrently instead of back to back; when this returns, the
+ * transport is accepting connections and jobs can be queued. Agent
+ * warmup continues in the background: each (type, config) line of the
+ * warm-state file (written by agent_cache_save(), tab-separated, '#'
+ * comments) is pre-created through create_agent() on a low-priority
+ * pool task and parked in the warm cache, so it never delays real
+ * work - an early job for a not-yet-warm type just pays the cold
+ * create it would have paid anyway.
+ *
+ * @param config Boot configuration
+ * @return 0 when the node is accepting, -1 if any subsystem failed
+ */
+int korra_warmstart_begin(const korra_warmstart_config_t* config);
+
+/**
+ * Whether background agent warmup has finished
+ *
+ * @return true once every warm-state entry has been processed
+ */
+bool korra_warmstart_ready(void);
+
+/**
+ * Block until background agent warmup finishes
+ *
+ * @return Number of agents pre-warmed
+ */
+int korra_warmstart_wait(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // KORRA_WARMSTART_H
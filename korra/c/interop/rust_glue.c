@@ -9,41 +9,283 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 #include "../include/rust_glue.h"
+#include "../include/arena.h"
+#include "../include/bufpool.h"
+#include "../include/stats.h"
+#define KORRA_LOG_MODULE KORRA_MODULE_INTEROP
 #include "../include/debug.h"
 
 // FFI callback function pointers
 static rust_agent_create_fn rust_agent_create = NULL;
 static rust_agent_execute_fn rust_agent_execute = NULL;
+static rust_agent_execute_batch_fn rust_agent_execute_batch = NULL;
 static rust_agent_destroy_fn rust_agent_destroy = NULL;
 
+// Per-execution arena. While an agent executes, every allocation the
+// Rust side routes through c_alloc_callback is a bump in a per-thread
+// region instead of a malloc; the whole region is released in one
+// reset once the output has been copied out. An execution that makes
+// 500 small allocations thus costs two libc calls, not a thousand.
+
+// First arena block size; covers typical executions without chaining
+#define EXEC_ARENA_SIZE (256 * 1024)
+
+static __thread korra_arena_t* exec_arena;      // reused across executions
+static __thread bool exec_arena_active;         // routes c_alloc_callback
+
+// Open the calling thread's execution arena
+static korra_arena_t* exec_arena_open(void) {
+    if (!exec_arena) {
+        exec_arena = korra_arena_create(EXEC_ARENA_SIZE);
+    }
+    if (exec_arena) {
+        exec_arena_active = true;
+    }
+    return exec_arena;
+}
+
+// Allocations at or above this size during an execution are served
+// from the buffer pool instead of the arena, so a large output can be
+// handed to the transport as a korra_buf_t without being copied
+#define EXEC_BUF_THRESHOLD (64 * 1024)
+
+// Pooled allocations tracked per execution
+#define EXEC_BUF_TRACKED 16
+
+typedef struct {
+    void* data;         // NULL = unused slot
+    korra_buf_t* buf;
+} exec_buf_entry_t;
+
+static __thread exec_buf_entry_t exec_bufs[EXEC_BUF_TRACKED];
+
+// Remember a pooled allocation so its handle can be recovered later;
+// returns false when the table is full (caller should not use the pool)
+static bool exec_buf_track(void* data, korra_buf_t* buf) {
+    for (int i = 0; i < EXEC_BUF_TRACKED; i++) {
+        if (!exec_bufs[i].data) {
+            exec_bufs[i].data = data;
+            exec_bufs[i].buf = buf;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Look up and clear a pooled allocation by its data pointer; returns
+// the buffer handle or NULL if the pointer is not pooled
+static korra_buf_t* exec_buf_take(const void* data) {
+    for (int i = 0; i < EXEC_BUF_TRACKED; i++) {
+        if (exec_bufs[i].data == data) {
+            exec_bufs[i].data = NULL;
+            return exec_bufs[i].buf;
+        }
+    }
+    return NULL;
+}
+
+// Release pooled allocations the execution never freed or returned
+static void exec_buf_release_all(void) {
+    for (int i = 0; i < EXEC_BUF_TRACKED; i++) {
+        if (exec_bufs[i].data) {
+            exec_bufs[i].data = NULL;
+            korra_buf_release(exec_bufs[i].buf);
+        }
+    }
+}
+
+// Move an output to the heap if it lives in the arena, so it survives
+// the reset and the caller's free() stays valid
+static void exec_arena_copy_out(void** output, size_t* output_size) {
+    if (!output || !*output || *output_size == 0) {
+        return;
+    }
+
+    // Pooled output going through the plain pointer API: the caller
+    // expects a free()-able pointer, so copy and release the handle
+    korra_buf_t* buf = exec_buf_take(*output);
+    if (buf) {
+        void* copy = malloc(*output_size);
+        if (copy) {
+            memcpy(copy, *output, *output_size);
+        } else {
+            ERROR_LOG("Failed to copy %zu byte output out of pool", *output_size);
+            *output_size = 0;
+        }
+        *output = copy;
+        korra_buf_release(buf);
+        return;
+    }
+
+    if (exec_arena && korra_arena_contains(exec_arena, *output)) {
+        void* copy = malloc(*output_size);
+        if (copy) {
+            memcpy(copy, *output, *output_size);
+        } else {
+            ERROR_LOG("Failed to copy %zu byte output out of arena", *output_size);
+            *output_size = 0;
+        }
+        *output = copy;
+    }
+}
+
+// Release the whole region in one shot, along with any pooled
+// allocations the execution left behind
+static void exec_arena_close(void) {
+    exec_arena_active = false;
+    exec_buf_release_all();
+    if (exec_arena) {
+        korra_arena_reset(exec_arena);
+    }
+}
+
+// Agent warm cache. The job router creates and destroys identically
+// configured agents constantly; each real create crosses into Rust and
+// re-parses the JSON config (~2ms). Instead, destroy_agent() parks the
+// handle in a per-(type, config) warm pool and create_agent() serves
+// the next identical request from it without touching Rust at all.
+
+// Distinct (agent_type, config) pairs tracked
+#define AGENT_CACHE_ENTRIES 32
+
+// Warm handles kept per pair
+#define AGENT_WARM_DEPTH 8
+
+// Outstanding handles we can map back to their cache entry
+#define MAX_LIVE_AGENTS 1024
+
+typedef struct {
+    char* agent_type;   // strdup'd key, NULL = unused slot
+    char* config;
+    agent_handle_t warm[AGENT_WARM_DEPTH];
+    int warm_count;
+} agent_cache_entry_t;
+
+typedef struct {
+    agent_handle_t handle;  // NULL = unused slot
+    int entry;              // index into agent_cache
+} live_agent_t;
+
+static agent_cache_entry_t agent_cache[AGENT_CACHE_ENTRIES];
+static live_agent_t live_agents[MAX_LIVE_AGENTS];
+static pthread_mutex_t agent_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Find or create the cache entry for a (type, config) pair; returns -1
+// when the table is full (such agents just bypass the cache)
+static int cache_entry_for(const char* agent_type, const char* config) {
+    int free_slot = -1;
+
+    for (int i = 0; i < AGENT_CACHE_ENTRIES; i++) {
+        if (!agent_cache[i].agent_type) {
+            if (free_slot < 0) {
+                free_slot = i;
+            }
+            continue;
+        }
+        if (strcmp(agent_cache[i].agent_type, agent_type) == 0 &&
+            strcmp(agent_cache[i].config, config) == 0) {
+            return i;
+        }
+    }
+
+    if (free_slot < 0) {
+        return -1;
+    }
+
+    agent_cache[free_slot].agent_type = strdup(agent_type);
+    agent_cache[free_slot].config = strdup(config);
+    if (!agent_cache[free_slot].agent_type || !agent_cache[free_slot].config) {
+        free(agent_cache[free_slot].agent_type);
+        free(agent_cache[free_slot].config);
+        agent_cache[free_slot].agent_type = NULL;
+        agent_cache[free_slot].config = NULL;
+        return -1;
+    }
+    agent_cache[free_slot].warm_count = 0;
+    return free_slot;
+}
+
+// Remember which entry an outstanding handle belongs to
+static void track_live_agent(agent_handle_t handle, int entry) {
+    for (int i = 0; i < MAX_LIVE_AGENTS; i++) {
+        if (!live_agents[i].handle) {
+            live_agents[i].handle = handle;
+            live_agents[i].entry = entry;
+            return;
+        }
+    }
+    // Table full: the handle will be destroyed for real on release
+}
+
+// Look up and clear a handle's live-table slot; returns the cache
+// entry index or -1 if untracked
+static int untrack_live_agent(agent_handle_t handle) {
+    for (int i = 0; i < MAX_LIVE_AGENTS; i++) {
+        if (live_agents[i].handle == handle) {
+            live_agents[i].handle = NULL;
+            return live_agents[i].entry;
+        }
+    }
+    return -1;
+}
+
 // Initialize Rust FFI
 int rust_ffi_init(rust_ffi_callbacks_t callbacks) {
     DEBUG_LOG("Initializing Rust FFI");
     
-    // Store callback function pointers
+    // Store callback function pointers (batch execute is optional)
     rust_agent_create = callbacks.agent_create;
     rust_agent_execute = callbacks.agent_execute;
+    rust_agent_execute_batch = callbacks.agent_execute_batch;
     rust_agent_destroy = callbacks.agent_destroy;
-    
+
     if (!rust_agent_create || !rust_agent_execute || !rust_agent_destroy) {
         ERROR_LOG("Invalid Rust FFI callbacks");
         return -1;
     }
-    
-    INFO_LOG("Rust FFI initialized successfully");
+
+    INFO_LOG("Rust FFI initialized successfully (batch execute %s)",
+             rust_agent_execute_batch ? "available" : "unavailable");
     return 0;
 }
 
-// Create a new agent instance
+// Create a new agent instance, serving warm handles when possible
 agent_handle_t create_agent(const char* agent_type, const char* config) {
     if (!rust_agent_create) {
         ERROR_LOG("Rust FFI not initialized");
         return NULL;
     }
-    
+
+    if (!agent_type || !config) {
+        ERROR_LOG("Invalid agent type or config");
+        return NULL;
+    }
+
+    // Cache hit: hand back a warm handle without crossing into Rust
+    pthread_mutex_lock(&agent_cache_mutex);
+    int entry = cache_entry_for(agent_type, config);
+    if (entry >= 0 && agent_cache[entry].warm_count > 0) {
+        agent_handle_t handle = agent_cache[entry].warm[--agent_cache[entry].warm_count];
+        track_live_agent(handle, entry);
+        pthread_mutex_unlock(&agent_cache_mutex);
+
+        DEBUG_LOG("Reusing warm agent of type '%s'", agent_type);
+        return handle;
+    }
+    pthread_mutex_unlock(&agent_cache_mutex);
+
     DEBUG_LOG("Creating agent of type '%s'", agent_type);
-    return rust_agent_create(agent_type, config);
+    agent_handle_t handle = rust_agent_create(agent_type, config);
+
+    if (handle && entry >= 0) {
+        pthread_mutex_lock(&agent_cache_mutex);
+        track_live_agent(handle, entry);
+        pthread_mutex_unlock(&agent_cache_mutex);
+    }
+
+    return handle;
 }
 
 // Execute an agent with provided input
@@ -60,25 +302,196 @@ int execute_agent(agent_handle_t handle, const void* input, size_t input_size,
     }
     
     DEBUG_LOG("Executing agent with %zu bytes of input", input_size);
-    return rust_agent_execute(handle, input, input_size, output, output_size);
+
+    // Scratch allocations made through c_alloc_callback during this
+    // execution land in the thread's arena and vanish in one reset
+    exec_arena_open();
+    uint64_t start = korra_stats_now_us();
+    int result = rust_agent_execute(handle, input, input_size, output, output_size);
+    korra_stats_record(KORRA_HIST_FFI_EXEC_US, korra_stats_now_us() - start);
+    korra_stats_count(KORRA_CTR_AGENT_EXECUTIONS, 1);
+    if (result == 0) {
+        exec_arena_copy_out(output, output_size);
+    }
+    exec_arena_close();
+
+    return result;
 }
 
-// Destroy an agent instance
+// Execute an agent against a pooled buffer, producing a pooled output.
+// Large payloads flow through without a single memcpy: the input is
+// consumed where the transport received it, and an output the Rust
+// side allocated through c_alloc_callback is handed back as the very
+// buffer it was written into.
+int execute_agent_buf(agent_handle_t handle, korra_buf_t* input, size_t input_size,
+                      korra_buf_t** output, size_t* output_size) {
+    if (!rust_agent_execute) {
+        ERROR_LOG("Rust FFI not initialized");
+        return -1;
+    }
+
+    if (!handle || !input || !output || !output_size) {
+        ERROR_LOG("Invalid buffered execution arguments");
+        return -1;
+    }
+
+    DEBUG_LOG("Executing agent in place with %zu bytes of input", input_size);
+
+    *output = NULL;
+    *output_size = 0;
+
+    exec_arena_open();
+    uint64_t start = korra_stats_now_us();
+    void* raw_output = NULL;
+    int result = rust_agent_execute(handle, korra_buf_data(input), input_size,
+                                    &raw_output, output_size);
+    korra_stats_record(KORRA_HIST_FFI_EXEC_US, korra_stats_now_us() - start);
+    korra_stats_count(KORRA_CTR_AGENT_EXECUTIONS, 1);
+
+    if (result == 0 && raw_output && *output_size > 0) {
+        // Pooled output: transfer the handle, zero copies
+        korra_buf_t* buf = exec_buf_take(raw_output);
+        if (!buf) {
+            // Small output from the arena or heap: stage it into a
+            // pooled buffer so the caller sees one handle type
+            buf = korra_buf_alloc(*output_size);
+            if (buf) {
+                memcpy(korra_buf_data(buf), raw_output, *output_size);
+            } else {
+                ERROR_LOG("Failed to pool %zu byte output", *output_size);
+                *output_size = 0;
+                result = -1;
+            }
+            if (!exec_arena || !korra_arena_contains(exec_arena, raw_output)) {
+                free(raw_output);
+            }
+        }
+        *output = buf;
+    }
+
+    exec_arena_close();
+    return result;
+}
+
+// Execute an agent across a whole batch of inputs in one FFI crossing
+int execute_agent_batch(agent_handle_t handle, const void** inputs, const size_t* input_sizes,
+                        int count, void** outputs, size_t* output_sizes) {
+    if (!rust_agent_execute) {
+        ERROR_LOG("Rust FFI not initialized");
+        return -1;
+    }
+
+    if (!handle || !inputs || !input_sizes || !outputs || !output_sizes || count < 0) {
+        ERROR_LOG("Invalid batch execution arguments");
+        return -1;
+    }
+
+    // Single crossing when the Rust side supports it
+    if (rust_agent_execute_batch) {
+        DEBUG_LOG("Executing agent batch of %d inputs in one crossing", count);
+        exec_arena_open();
+        uint64_t start = korra_stats_now_us();
+        int result = rust_agent_execute_batch(handle, inputs, input_sizes, count,
+                                              outputs, output_sizes);
+        korra_stats_record(KORRA_HIST_FFI_EXEC_US, korra_stats_now_us() - start);
+        korra_stats_count(KORRA_CTR_AGENT_EXECUTIONS, (uint64_t)count);
+        for (int i = 0; i < count; i++) {
+            exec_arena_copy_out(&outputs[i], &output_sizes[i]);
+        }
+        exec_arena_close();
+        return result;
+    }
+
+    // Fallback: per-input crossings, same result shape
+    DEBUG_LOG("Executing agent batch of %d inputs (no batch callback)", count);
+    int succeeded = 0;
+    for (int i = 0; i < count; i++) {
+        outputs[i] = NULL;
+        output_sizes[i] = 0;
+        if (execute_agent(handle, inputs[i], input_sizes[i],
+                          &outputs[i], &output_sizes[i]) == 0) {
+            succeeded++;
+        }
+    }
+
+    return succeeded;
+}
+
+// Destroy an agent instance, parking it in the warm pool when possible
 void destroy_agent(agent_handle_t handle) {
     if (!rust_agent_destroy) {
         ERROR_LOG("Rust FFI not initialized");
         return;
     }
-    
+
     if (!handle) {
         ERROR_LOG("Invalid agent handle");
         return;
     }
-    
+
+    pthread_mutex_lock(&agent_cache_mutex);
+    int entry = untrack_live_agent(handle);
+    if (entry >= 0 && agent_cache[entry].warm_count < AGENT_WARM_DEPTH) {
+        agent_cache[entry].warm[agent_cache[entry].warm_count++] = handle;
+        pthread_mutex_unlock(&agent_cache_mutex);
+
+        DEBUG_LOG("Parked agent in warm pool");
+        return;
+    }
+    pthread_mutex_unlock(&agent_cache_mutex);
+
     DEBUG_LOG("Destroying agent");
     rust_agent_destroy(handle);
 }
 
+// Evict every warm handle, destroying the agents for real
+void agent_cache_flush(void) {
+    agent_handle_t doomed[AGENT_CACHE_ENTRIES * AGENT_WARM_DEPTH];
+    int doomed_count = 0;
+
+    pthread_mutex_lock(&agent_cache_mutex);
+    for (int i = 0; i < AGENT_CACHE_ENTRIES; i++) {
+        agent_cache_entry_t* cache_entry = &agent_cache[i];
+        while (cache_entry->warm_count > 0) {
+            doomed[doomed_count++] = cache_entry->warm[--cache_entry->warm_count];
+        }
+    }
+    pthread_mutex_unlock(&agent_cache_mutex);
+
+    // Cross into Rust outside the lock
+    for (int i = 0; i < doomed_count; i++) {
+        rust_agent_destroy(doomed[i]);
+    }
+
+    if (doomed_count > 0) {
+        INFO_LOG("Flushed %d warm agents", doomed_count);
+    }
+}
+
+// Snapshot the known (type, config) pairs for warm starts
+int agent_cache_save(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        perror("Failed to open warm-state file");
+        return -1;
+    }
+
+    int saved = 0;
+    pthread_mutex_lock(&agent_cache_mutex);
+    for (int i = 0; i < AGENT_CACHE_ENTRIES; i++) {
+        if (!agent_cache[i].agent_type) {
+            continue;
+        }
+        fprintf(file, "%s\t%s\n", agent_cache[i].agent_type, agent_cache[i].config);
+        saved++;
+    }
+    pthread_mutex_unlock(&agent_cache_mutex);
+
+    fclose(file);
+    DEBUG_LOG("Saved %d agent configs to %s", saved, path);
+    return saved;
+}
+
 // C callback for Rust to call
 void c_log_callback(int level, const char* message) {
     switch (level) {
@@ -91,25 +504,58 @@ void c_log_callback(int level, const char* message) {
     }
 }
 
-// C callback for memory allocation (used by Rust)
+// C callback for memory allocation (used by Rust). During an agent
+// execution this is a bump in the per-thread arena; outside one it
+// falls back to malloc. No per-allocation logging: executions make
+// hundreds of these and the formatting alone dominated the crossing.
 void* c_alloc_callback(size_t size) {
+    if (exec_arena_active) {
+        // Large allocations come from the buffer pool so they can be
+        // handed onward as korra_buf_t handles without a copy
+        if (size >= EXEC_BUF_THRESHOLD) {
+            korra_buf_t* buf = korra_buf_alloc(size);
+            if (buf) {
+                void* data = korra_buf_data(buf);
+                if (exec_buf_track(data, buf)) {
+                    return data;
+                }
+                // Tracking table full: an untracked pooled pointer
+                // could never be freed, so give it back
+                korra_buf_release(buf);
+            }
+        }
+
+        void* ptr = korra_arena_alloc(exec_arena, size);
+        if (ptr) {
+            return ptr;
+        }
+        // Arena exhausted and could not grow; fall through to malloc
+    }
+
     void* ptr = malloc(size);
     if (!ptr) {
         ERROR_LOG("Failed to allocate %zu bytes", size);
-        return NULL;
     }
-    
-    DEBUG_LOG("Allocated %zu bytes at %p", size, ptr);
     return ptr;
 }
 
-// C callback for memory deallocation (used by Rust)
+// C callback for memory deallocation (used by Rust). Arena pointers
+// are a no-op here; they are released wholesale when the execution's
+// arena is reset.
 void c_free_callback(void* ptr) {
     if (!ptr) {
-        ERROR_LOG("Attempt to free NULL pointer");
         return;
     }
-    
-    DEBUG_LOG("Freeing memory at %p", ptr);
+
+    korra_buf_t* buf = exec_buf_take(ptr);
+    if (buf) {
+        korra_buf_release(buf);
+        return;
+    }
+
+    if (exec_arena && korra_arena_contains(exec_arena, ptr)) {
+        return;
+    }
+
     free(ptr);
 }
\ No newline at end of file
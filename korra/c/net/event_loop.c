@@ -0,0 +1,208 @@
+/**
+ * @file event_loop.c
+ * @brief Multi-connection epoll event loop for the KORRA transport
+ *
+ * One epoll instance owns every peer connection. The loop thread only
+ * waits and accepts; actual message receives run as thread pool tasks,
+ * so a slow handler never stalls the other connections. Connections
+ * are armed with EPOLLONESHOT and re-armed after each message, which
+ * guarantees a single worker reads a given fd at a time.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "../include/event_loop.h"
+#include "../include/transport.h"
+#include "../include/thread.h"
+#define KORRA_LOG_MODULE KORRA_MODULE_NET
+#include "../include/debug.h"
+
+// Maximum events drained per epoll_wait call
+#define MAX_EPOLL_EVENTS 64
+
+// Event loop state
+typedef struct {
+    int epoll_fd;
+    int stop_fd;                        // eventfd used to break the wait
+    event_message_handler_t handler;
+    bool running;
+} event_loop_t;
+
+static event_loop_t loop;
+
+// Pool task: receive one message from a readable connection, hand it
+// to the handler, then re-arm the fd for the next event
+static void connection_readable(void* arg) {
+    int fd = (int)(intptr_t)arg;
+    transport_message_t message;
+
+    int result = transport_receive_fd(fd, &message);
+    if (result != 0 && result != TRANSPORT_WOULDBLOCK) {
+        if (result == TRANSPORT_CLOSED) {
+            DEBUG_LOG("Connection %d closed by peer", fd);
+        } else {
+            WARN_LOG("Receive failed on connection %d, dropping it", fd);
+        }
+        event_loop_remove_connection(fd);
+        if (loop.handler) {
+            loop.handler(fd, NULL);
+        }
+        return;
+    }
+
+    if (result == 0 && loop.handler) {
+        loop.handler(fd, &message);
+    }
+
+    // Re-arm for the next message (EPOLLONESHOT disarmed the fd); an
+    // incomplete frame just waits for more bytes to arrive
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.fd = fd;
+    if (epoll_ctl(loop.epoll_fd, EPOLL_CTL_MOD, fd, &event) < 0) {
+        perror("Failed to re-arm connection");
+        event_loop_remove_connection(fd);
+    }
+}
+
+int event_loop_init(event_message_handler_t handler) {
+    DEBUG_LOG("Initializing event loop");
+
+    memset(&loop, 0, sizeof(event_loop_t));
+    loop.handler = handler;
+
+    loop.epoll_fd = epoll_create1(0);
+    if (loop.epoll_fd < 0) {
+        perror("Failed to create epoll instance");
+        return -1;
+    }
+
+    loop.stop_fd = eventfd(0, 0);
+    if (loop.stop_fd < 0) {
+        perror("Failed to create stop eventfd");
+        close(loop.epoll_fd);
+        return -1;
+    }
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = loop.stop_fd;
+    if (epoll_ctl(loop.epoll_fd, EPOLL_CTL_ADD, loop.stop_fd, &event) < 0) {
+        perror("Failed to register stop eventfd");
+        close(loop.stop_fd);
+        close(loop.epoll_fd);
+        return -1;
+    }
+
+    // Register the listening socket if this node is a server
+    int listen_fd = transport_listen_fd();
+    if (listen_fd >= 0) {
+        event.events = EPOLLIN;
+        event.data.fd = listen_fd;
+        if (epoll_ctl(loop.epoll_fd, EPOLL_CTL_ADD, listen_fd, &event) < 0) {
+            perror("Failed to register listening socket");
+            close(loop.stop_fd);
+            close(loop.epoll_fd);
+            return -1;
+        }
+    }
+
+    INFO_LOG("Event loop initialized");
+    return 0;
+}
+
+int event_loop_add_connection(int fd) {
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.fd = fd;
+
+    if (epoll_ctl(loop.epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        perror("Failed to add connection to event loop");
+        return -1;
+    }
+
+    DEBUG_LOG("Connection %d added to event loop", fd);
+    return 0;
+}
+
+int event_loop_remove_connection(int fd) {
+    if (epoll_ctl(loop.epoll_fd, EPOLL_CTL_DEL, fd, NULL) < 0) {
+        perror("Failed to remove connection from event loop");
+        // Fall through and close anyway
+    }
+
+    close(fd);
+    DEBUG_LOG("Connection %d removed from event loop", fd);
+    return 0;
+}
+
+int event_loop_run(void) {
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    int listen_fd = transport_listen_fd();
+
+    loop.running = true;
+    INFO_LOG("Event loop running");
+
+    while (loop.running) {
+        int ready = epoll_wait(loop.epoll_fd, events, MAX_EPOLL_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait failed");
+            return -1;
+        }
+
+        for (int i = 0; i < ready; i++) {
+            int fd = events[i].data.fd;
+
+            if (fd == loop.stop_fd) {
+                uint64_t value;
+                if (read(loop.stop_fd, &value, sizeof(value)) < 0) {
+                    perror("Failed to drain stop eventfd");
+                }
+                loop.running = false;
+                break;
+            }
+
+            if (fd == listen_fd) {
+                int client_fd;
+                if (transport_accept(&client_fd) == 0) {
+                    event_loop_add_connection(client_fd);
+                }
+                continue;
+            }
+
+            // Readable connection: dispatch the receive to the pool so
+            // the loop thread goes straight back to waiting
+            thread_task_t task;
+            memset(&task, 0, sizeof(task));
+            snprintf(task.name, sizeof(task.name), "net-recv-%d", fd);
+            task.function = connection_readable;
+            task.arg = (void*)(intptr_t)fd;
+
+            if (thread_pool_submit(task) != 0) {
+                WARN_LOG("Failed to dispatch receive for connection %d", fd);
+            }
+        }
+    }
+
+    INFO_LOG("Event loop stopped");
+    return 0;
+}
+
+void event_loop_stop(void) {
+    loop.running = false;
+
+    uint64_t value = 1;
+    if (write(loop.stop_fd, &value, sizeof(value)) < 0) {
+        perror("Failed to signal event loop stop");
+    }
+}
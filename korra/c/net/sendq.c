@@ -0,0 +1,434 @@
+/**
+ * @file sendq.c
+ * @brief Per-connection outbound queue with an mmap-backed spill journal
+ *
+ * transport_send() writes straight into the kernel socket buffer, so
+ * one stalled peer can wedge every pool worker that touches its
+ * connection. This module decouples producers from the socket: an
+ * append copies the frame into a per-connection ring of pooled
+ * buffers and returns; a single drain thread writes records out with
+ * MSG_DONTWAIT as each socket accepts them. When a ring fills, whole
+ * records spill to a memory-mapped journal file in order, and appends
+ * keep going to the journal until it drains so ordering is preserved.
+ * Because the journal is a file of complete frames with persistent
+ * read/write offsets, it doubles as a replay log: after a reconnect,
+ * korra_sendq_reattach() resumes from the last record boundary
+ * instead of forcing a full state resync.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include "../include/sendq.h"
+#include "../include/bufpool.h"
+#define KORRA_LOG_MODULE KORRA_MODULE_NET
+#include "../include/debug.h"
+
+// Open queues tracked at once
+#define MAX_SENDQS 64
+
+// Records buffered in memory per connection before spilling
+#define SENDQ_RING_RECORDS 1024
+
+// Journal capacity (records beyond this are rejected)
+#define SENDQ_JOURNAL_SIZE (64u * 1024 * 1024)
+
+// Journal file header, mapped shared so offsets survive the process
+typedef struct {
+    uint64_t write_off;     // next append position
+    uint64_t read_off;      // start of the oldest undelivered record
+} journal_header_t;
+
+// One in-memory record
+typedef struct {
+    korra_buf_t* buf;
+    uint32_t size;
+} sendq_record_t;
+
+typedef struct {
+    int fd;                 // -1 = slot unused
+    pthread_mutex_t mutex;
+
+    // In-memory ring of whole records
+    sendq_record_t ring[SENDQ_RING_RECORDS];
+    size_t head;            // drain position
+    size_t tail;            // append position
+    size_t sent;            // bytes of ring[head] already written
+
+    // Spill journal
+    int journal_fd;
+    uint8_t* journal;       // mmap base (header + records)
+    journal_header_t* jh;
+    size_t journal_sent;    // bytes of the current journal record written
+    bool spilling;          // appends must go to the journal for ordering
+
+    bool stalled;           // socket dead, waiting for reattach
+    char journal_path[256]; // kept so close() can delete the file
+} sendq_t;
+
+static sendq_t sendqs[MAX_SENDQS];
+static pthread_mutex_t sendq_table_mutex = PTHREAD_MUTEX_INITIALIZER;
+static atomic_bool drain_running;
+static pthread_t drain_thread;
+
+// Find the slot for a connection; table mutex must be held or the
+// slot known to be stable
+static sendq_t* sendq_for(int fd) {
+    if (fd <= 0) {
+        // 0 and -1 both mark unused slots
+        return NULL;
+    }
+    for (int i = 0; i < MAX_SENDQS; i++) {
+        if (sendqs[i].fd == fd) {
+            return &sendqs[i];
+        }
+    }
+    return NULL;
+}
+
+// Append one record to the journal; queue mutex held
+static int journal_append(sendq_t* queue, const void* frame, size_t size) {
+    uint64_t needed = sizeof(uint32_t) + size;
+
+    if (queue->jh->write_off + needed > SENDQ_JOURNAL_SIZE) {
+        // Compact if everything before read_off is already delivered
+        uint64_t pending = queue->jh->write_off - queue->jh->read_off;
+        if (pending == 0) {
+            queue->jh->read_off = sizeof(journal_header_t);
+            queue->jh->write_off = sizeof(journal_header_t);
+        }
+        if (queue->jh->write_off + needed > SENDQ_JOURNAL_SIZE) {
+            WARN_LOG("Send journal full for fd %d, rejecting %zu byte frame",
+                     queue->fd, size);
+            return -1;
+        }
+    }
+
+    uint32_t record_size = (uint32_t)size;
+    memcpy(queue->journal + queue->jh->write_off, &record_size, sizeof(record_size));
+    memcpy(queue->journal + queue->jh->write_off + sizeof(record_size), frame, size);
+    queue->jh->write_off += needed;
+    return 0;
+}
+
+// Write as much of one queue as its socket accepts; queue mutex held.
+// Returns true if any progress was made.
+static bool drain_queue(sendq_t* queue) {
+    bool progressed = false;
+
+    if (queue->stalled) {
+        return false;
+    }
+
+    // Ring first: it holds the records from before the spill started
+    while (queue->head != queue->tail) {
+        sendq_record_t* record = &queue->ring[queue->head % SENDQ_RING_RECORDS];
+        uint8_t* data = korra_buf_data(record->buf);
+
+        ssize_t n = send(queue->fd, data + queue->sent, record->size - queue->sent,
+                         MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                return progressed;
+            }
+            DEBUG_LOG("Send queue socket fd %d failed, stalling until reattach",
+                      queue->fd);
+            queue->stalled = true;
+            return progressed;
+        }
+
+        queue->sent += (size_t)n;
+        progressed = true;
+        if (queue->sent < record->size) {
+            return progressed;
+        }
+
+        korra_buf_release(record->buf);
+        record->buf = NULL;
+        queue->head++;
+        queue->sent = 0;
+    }
+
+    // Then the journal, record at a time from the read offset
+    while (queue->jh->read_off < queue->jh->write_off) {
+        uint32_t record_size;
+        memcpy(&record_size, queue->journal + queue->jh->read_off, sizeof(record_size));
+        uint8_t* data = queue->journal + queue->jh->read_off + sizeof(record_size);
+
+        ssize_t n = send(queue->fd, data + queue->journal_sent,
+                         record_size - queue->journal_sent,
+                         MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                return progressed;
+            }
+            DEBUG_LOG("Send queue socket fd %d failed, stalling until reattach",
+                      queue->fd);
+            queue->stalled = true;
+            return progressed;
+        }
+
+        queue->journal_sent += (size_t)n;
+        progressed = true;
+        if (queue->journal_sent < record_size) {
+            return progressed;
+        }
+
+        queue->jh->read_off += sizeof(record_size) + record_size;
+        queue->journal_sent = 0;
+    }
+
+    // Journal fully drained: compact it and let appends use the ring
+    if (queue->spilling) {
+        queue->jh->read_off = sizeof(journal_header_t);
+        queue->jh->write_off = sizeof(journal_header_t);
+        queue->spilling = false;
+    }
+
+    return progressed;
+}
+
+// Drain thread: sweep every open queue, sleeping only when idle
+static void* drain_worker(void* arg) {
+    (void)arg;
+    debug_set_thread_name("korra-sendq");
+
+    while (atomic_load_explicit(&drain_running, memory_order_acquire)) {
+        bool progressed = false;
+
+        for (int i = 0; i < MAX_SENDQS; i++) {
+            sendq_t* queue = &sendqs[i];
+            if (queue->fd <= 0) {
+                continue;
+            }
+
+            pthread_mutex_lock(&queue->mutex);
+            if (queue->fd > 0 && drain_queue(queue)) {
+                progressed = true;
+            }
+            pthread_mutex_unlock(&queue->mutex);
+        }
+
+        if (!progressed) {
+            usleep(1000);
+        }
+    }
+
+    return NULL;
+}
+
+int korra_sendq_open(int fd, const char* journal_path) {
+    if (fd < 0 || !journal_path) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&sendq_table_mutex);
+
+    if (sendq_for(fd)) {
+        pthread_mutex_unlock(&sendq_table_mutex);
+        return -1;
+    }
+
+    sendq_t* queue = NULL;
+    for (int i = 0; i < MAX_SENDQS; i++) {
+        if (sendqs[i].fd == 0 || sendqs[i].fd == -1) {
+            // fd 0 marks a never-used slot (static zero init)
+            queue = &sendqs[i];
+            break;
+        }
+    }
+    if (!queue) {
+        pthread_mutex_unlock(&sendq_table_mutex);
+        ERROR_LOG("Send queue table full");
+        return -1;
+    }
+
+    int journal_fd = open(journal_path, O_RDWR | O_CREAT, 0644);
+    if (journal_fd < 0) {
+        perror("Failed to open send journal");
+        pthread_mutex_unlock(&sendq_table_mutex);
+        return -1;
+    }
+    if (ftruncate(journal_fd, SENDQ_JOURNAL_SIZE) != 0) {
+        perror("Failed to size send journal");
+        close(journal_fd);
+        pthread_mutex_unlock(&sendq_table_mutex);
+        return -1;
+    }
+
+    uint8_t* journal = mmap(NULL, SENDQ_JOURNAL_SIZE, PROT_READ | PROT_WRITE,
+                            MAP_SHARED, journal_fd, 0);
+    if (journal == MAP_FAILED) {
+        perror("Failed to map send journal");
+        close(journal_fd);
+        pthread_mutex_unlock(&sendq_table_mutex);
+        return -1;
+    }
+
+    memset(queue, 0, sizeof(sendq_t));
+    pthread_mutex_init(&queue->mutex, NULL);
+    snprintf(queue->journal_path, sizeof(queue->journal_path), "%s", journal_path);
+    queue->journal_fd = journal_fd;
+    queue->journal = journal;
+    queue->jh = (journal_header_t*)journal;
+
+    // A journal left over from a previous run keeps its offsets, so
+    // undelivered records replay to this connection
+    if (queue->jh->write_off < sizeof(journal_header_t) ||
+        queue->jh->write_off > SENDQ_JOURNAL_SIZE ||
+        queue->jh->read_off > queue->jh->write_off) {
+        queue->jh->read_off = sizeof(journal_header_t);
+        queue->jh->write_off = sizeof(journal_header_t);
+    }
+    if (queue->jh->read_off < queue->jh->write_off) {
+        INFO_LOG("Replaying %llu journal bytes for fd %d",
+                 (unsigned long long)(queue->jh->write_off - queue->jh->read_off), fd);
+        queue->spilling = true;
+    }
+
+    queue->fd = fd;
+
+    // First queue starts the drain thread
+    if (!atomic_load(&drain_running)) {
+        atomic_store(&drain_running, true);
+        if (pthread_create(&drain_thread, NULL, drain_worker, NULL) != 0) {
+            perror("Failed to create send queue drain thread");
+            atomic_store(&drain_running, false);
+            queue->fd = -1;
+            munmap(journal, SENDQ_JOURNAL_SIZE);
+            close(journal_fd);
+            pthread_mutex_unlock(&sendq_table_mutex);
+            return -1;
+        }
+    }
+
+    pthread_mutex_unlock(&sendq_table_mutex);
+    DEBUG_LOG("Send queue open for fd %d, journal %s", fd, journal_path);
+    return 0;
+}
+
+int korra_sendq_append(int fd, const void* frame, size_t size) {
+    if (!frame || size == 0) {
+        return -1;
+    }
+
+    sendq_t* queue = sendq_for(fd);
+    if (!queue) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&queue->mutex);
+
+    // Once spilling, everything goes through the journal so records
+    // stay in order
+    if (!queue->spilling && queue->tail - queue->head < SENDQ_RING_RECORDS) {
+        korra_buf_t* buf = korra_buf_alloc(size);
+        if (!buf) {
+            pthread_mutex_unlock(&queue->mutex);
+            return -1;
+        }
+        memcpy(korra_buf_data(buf), frame, size);
+
+        sendq_record_t* record = &queue->ring[queue->tail % SENDQ_RING_RECORDS];
+        record->buf = buf;
+        record->size = (uint32_t)size;
+        queue->tail++;
+        pthread_mutex_unlock(&queue->mutex);
+        return 0;
+    }
+
+    if (!queue->spilling) {
+        DEBUG_LOG("Send ring full for fd %d, spilling to journal", fd);
+        queue->spilling = true;
+    }
+
+    int result = journal_append(queue, frame, size);
+    pthread_mutex_unlock(&queue->mutex);
+    return result;
+}
+
+int korra_sendq_reattach(int old_fd, int new_fd) {
+    pthread_mutex_lock(&sendq_table_mutex);
+    sendq_t* queue = sendq_for(old_fd);
+    if (!queue || sendq_for(new_fd)) {
+        pthread_mutex_unlock(&sendq_table_mutex);
+        return -1;
+    }
+
+    pthread_mutex_lock(&queue->mutex);
+    queue->fd = new_fd;
+    queue->stalled = false;
+    // Restart the in-flight record from its boundary: the old socket
+    // died mid-frame, the new one must see whole frames
+    queue->sent = 0;
+    queue->journal_sent = 0;
+    pthread_mutex_unlock(&queue->mutex);
+    pthread_mutex_unlock(&sendq_table_mutex);
+
+    INFO_LOG("Send queue reattached from fd %d to fd %d", old_fd, new_fd);
+    return 0;
+}
+
+int korra_sendq_pending(int fd) {
+    sendq_t* queue = sendq_for(fd);
+    if (!queue) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&queue->mutex);
+    int pending = (int)(queue->tail - queue->head);
+    uint64_t journal_off = queue->jh->read_off;
+    while (journal_off < queue->jh->write_off) {
+        uint32_t record_size;
+        memcpy(&record_size, queue->journal + journal_off, sizeof(record_size));
+        journal_off += sizeof(record_size) + record_size;
+        pending++;
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return pending;
+}
+
+void korra_sendq_close(int fd) {
+    pthread_mutex_lock(&sendq_table_mutex);
+    sendq_t* queue = sendq_for(fd);
+    if (!queue) {
+        pthread_mutex_unlock(&sendq_table_mutex);
+        return;
+    }
+
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->head != queue->tail) {
+        korra_buf_release(queue->ring[queue->head % SENDQ_RING_RECORDS].buf);
+        queue->head++;
+    }
+    munmap(queue->journal, SENDQ_JOURNAL_SIZE);
+    close(queue->journal_fd);
+    unlink(queue->journal_path);
+    queue->fd = -1;
+    pthread_mutex_unlock(&queue->mutex);
+    pthread_mutex_unlock(&sendq_table_mutex);
+}
+
+void korra_sendq_shutdown(void) {
+    if (atomic_load(&drain_running)) {
+        atomic_store(&drain_running, false);
+        pthread_join(drain_thread, NULL);
+    }
+
+    for (int i = 0; i < MAX_SENDQS; i++) {
+        if (sendqs[i].fd > 0) {
+            korra_sendq_close(sendqs[i].fd);
+        }
+    }
+}
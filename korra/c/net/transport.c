@@ -7,12 +7,19 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <limits.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <errno.h>
 #include "../include/transport.h"
+#include "../include/compress.h"
+#include "../include/crc32c.h"
+#include "../include/sendq.h"
+#include "../include/stats.h"
+#define KORRA_LOG_MODULE KORRA_MODULE_NET
 #include "../include/debug.h"
 
 // Message header magic number
@@ -21,23 +28,75 @@
 // Socket buffer sizes
 #define SOCKET_BUFFER_SIZE 8192
 
+// Highest fd the per-connection state tables cover
+#define MAX_TRACKED_FDS 4096
+
+// Not exposed by limits.h without POSIX feature macros; 1024 is the
+// Linux value
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
 // Socket state
 typedef struct {
     int socket_fd;
+    int udp_fd;         // datagram fast path; -1 when unavailable
     struct sockaddr_in address;
+    struct sockaddr_in udp_peer;    // last datagram sender (server side)
+    bool udp_peer_known;
     bool is_server;
     bool is_connected;
 } transport_socket_t;
 
 static transport_socket_t transport_socket;
 
+// Largest payload sent over the datagram path: one MTU minus IP, UDP
+// and transport headers, so a fast-path message never fragments
+#define UDP_MAX_PAYLOAD 1400
+
+// True for messages that ride the UDP fast path: small, loss-tolerant
+// control traffic. Bulk and must-arrive types stay on the TCP stream,
+// so a megabyte state sync can no longer head-of-line-block heartbeats.
+static bool udp_eligible(const transport_message_t* message) {
+    if (message->payload_size > UDP_MAX_PAYLOAD) {
+        return false;
+    }
+    return message->msg_type == MSG_HEARTBEAT || message->msg_type == MSG_NODE_INFO;
+}
+
+// Payloads below this size aren't worth a compression pass
+#define COMPRESS_MIN_SIZE 4096
+
+// Outbound compression toggle (receive always decompresses)
+static bool compression_enabled = false;
+
+void transport_set_compression(bool enable) {
+    compression_enabled = enable;
+    INFO_LOG("Transport compression %s", enable ? "enabled" : "disabled");
+}
+
+// Crash dumper: the socket state tells a postmortem whether the node
+// was serving, connected, and on which fd. write()-only helpers keep
+// this async-signal-safe.
+static void transport_crash_dump(int fd) {
+    debug_write_str(fd, "Transport: fd=");
+    debug_write_dec(fd, transport_socket.socket_fd);
+    debug_write_str(fd, " port=");
+    debug_write_dec(fd, ntohs(transport_socket.address.sin_port));
+    debug_write_str(fd, transport_socket.is_server ? " server" : " client");
+    debug_write_str(fd, transport_socket.is_connected ? " connected\n" : " disconnected\n");
+}
+
 int transport_init(int port, bool is_server) {
     DEBUG_LOG("Initializing transport on port %d, is_server: %d", port, is_server);
-    
+
+    debug_register_crash_dumper(transport_crash_dump);
+
     // Initialize socket state
     memset(&transport_socket, 0, sizeof(transport_socket_t));
     transport_socket.is_server = is_server;
     transport_socket.is_connected = false;
+    transport_socket.udp_fd = -1;
     
     // Create socket
     transport_socket.socket_fd = socket(AF_INET, SOCK_STREAM, 0);
@@ -86,104 +145,915 @@ int transport_init(int port, bool is_server) {
         transport_socket.is_connected = true;
         DEBUG_LOG("Transport initialized as client, connected to port %d", port);
     }
-    
+
+    // Datagram fast path on the same port: heartbeats and small
+    // control messages bypass the TCP stream entirely, so their
+    // latency stays flat while a bulk transfer is in flight. Failure
+    // to set it up is not fatal - everything still flows over TCP.
+    transport_socket.udp_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (transport_socket.udp_fd >= 0) {
+        int udp_ok;
+        if (is_server) {
+            int opt = 1;
+            setsockopt(transport_socket.udp_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+            udp_ok = bind(transport_socket.udp_fd,
+                          (struct sockaddr*)&transport_socket.address,
+                          sizeof(transport_socket.address)) == 0;
+        } else {
+            // connect() pins the peer so plain send()/recv() work and
+            // stray datagrams are filtered by the kernel
+            udp_ok = connect(transport_socket.udp_fd,
+                             (struct sockaddr*)&transport_socket.address,
+                             sizeof(transport_socket.address)) == 0;
+        }
+
+        if (!udp_ok) {
+            perror("Failed to set up UDP fast path");
+            close(transport_socket.udp_fd);
+            transport_socket.udp_fd = -1;
+        } else {
+            DEBUG_LOG("UDP fast path ready on port %d", port);
+        }
+    }
+
+    return 0;
+}
+
+// Fill in the wire header for a message. The checksum covers the
+// payload exactly as it ships; senders that transform the payload
+// afterwards (compression) recompute it.
+static void prepare_header(transport_header_t* header, const transport_message_t* message) {
+    header->magic = KORRA_MSG_MAGIC;
+    header->version = KORRA_PROTOCOL_VERSION;
+    header->msg_type = message->msg_type;
+    header->reserved = 0;
+    header->payload_size = message->payload_size;
+    header->checksum = message->payload_size > 0
+                           ? korra_crc32c(message->payload, message->payload_size)
+                           : 0;
+}
+
+// Write an iovec array fully, retrying across short writes
+static int writev_all(int fd, struct iovec* iov, int iov_count) {
+    while (iov_count > 0) {
+        ssize_t written = writev(fd, iov, iov_count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("Failed to write message data");
+            return -1;
+        }
+
+        // Advance past fully written entries, trim the partial one
+        while (iov_count > 0 && (size_t)written >= iov->iov_len) {
+            written -= iov->iov_len;
+            iov++;
+            iov_count--;
+        }
+        if (iov_count > 0) {
+            iov->iov_base = (char*)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+
+    return 0;
+}
+
+int transport_send_fd(int fd, const transport_message_t* message) {
+    // Prepare header
+    transport_header_t header;
+    prepare_header(&header, message);
+
+    void* payload = message->payload;
+    uint32_t payload_size = message->payload_size;
+    korra_buf_t* compressed = NULL;
+
+    // Compress large payloads; ship the original if it doesn't shrink.
+    // The compressed payload starts with the original size so the
+    // receiver can allocate before decompressing.
+    if (compression_enabled && payload_size >= COMPRESS_MIN_SIZE) {
+        compressed = korra_buf_alloc(sizeof(uint32_t) + korra_compress_bound(payload_size));
+        if (compressed) {
+            uint8_t* data = korra_buf_data(compressed);
+            long compressed_size = korra_compress(payload, payload_size,
+                                                  data + sizeof(uint32_t),
+                                                  korra_buf_capacity(compressed) - sizeof(uint32_t));
+
+            if (compressed_size > 0 &&
+                sizeof(uint32_t) + (size_t)compressed_size < payload_size) {
+                memcpy(data, &payload_size, sizeof(uint32_t));
+                payload = data;
+                payload_size = sizeof(uint32_t) + (uint32_t)compressed_size;
+                header.reserved |= TRANSPORT_FLAG_COMPRESSED;
+                header.payload_size = payload_size;
+                header.checksum = korra_crc32c(payload, payload_size);
+                DEBUG_LOG("Compressed payload %u -> %u bytes",
+                          message->payload_size, payload_size);
+            } else {
+                korra_buf_release(compressed);
+                compressed = NULL;
+            }
+        }
+    }
+
+    // Send header and payload in one writev: one syscall, one packet
+    struct iovec iov[2];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = payload;
+    iov[1].iov_len = payload_size;
+
+    int result = writev_all(fd, iov, payload_size > 0 ? 2 : 1);
+    korra_buf_release(compressed);
+
+    if (result != 0) {
+        return -1;
+    }
+
+    korra_stats_message_sent(message->msg_type, message->payload_size);
+    DEBUG_LOG("Sent message type %d, size %d", message->msg_type, message->payload_size);
+    return 0;
+}
+
+int transport_send_queued_fd(int fd, const transport_message_t* message) {
+    transport_header_t header;
+    prepare_header(&header, message);
+
+    // The queue stores complete wire frames, so header and payload are
+    // framed into one contiguous record here. Compression is skipped:
+    // queued traffic is latency-insensitive by definition and the
+    // journal would otherwise hold payloads it can't re-checksum.
+    size_t frame_size = sizeof(header) + message->payload_size;
+    uint8_t* frame = malloc(frame_size);
+    if (!frame) {
+        perror("Failed to allocate queued frame");
+        return -1;
+    }
+    memcpy(frame, &header, sizeof(header));
+    if (message->payload_size > 0) {
+        memcpy(frame + sizeof(header), message->payload, message->payload_size);
+    }
+
+    int result = korra_sendq_append(fd, frame, frame_size);
+    free(frame);
+
+    if (result == 0) {
+        korra_stats_message_sent(message->msg_type, message->payload_size);
+        DEBUG_LOG("Queued message type %d, size %d", message->msg_type,
+                  message->payload_size);
+    }
+    return result;
+}
+
+// Send a message as a single datagram with the same wire framing.
+// Returns -1 when the fast path can't be used; the caller falls back
+// to the TCP stream.
+static int udp_send(const transport_message_t* message) {
+    if (transport_socket.udp_fd < 0) {
+        return -1;
+    }
+    if (transport_socket.is_server && !transport_socket.udp_peer_known) {
+        // No datagram from the peer yet, so nowhere to send
+        return -1;
+    }
+
+    transport_header_t header;
+    prepare_header(&header, message);
+
+    struct iovec iov[2];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = message->payload;
+    iov[1].iov_len = message->payload_size;
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = message->payload_size > 0 ? 2 : 1;
+    if (transport_socket.is_server) {
+        msg.msg_name = &transport_socket.udp_peer;
+        msg.msg_namelen = sizeof(transport_socket.udp_peer);
+    }
+
+    if (sendmsg(transport_socket.udp_fd, &msg, 0) < 0) {
+        return -1;
+    }
+
+    korra_stats_message_sent(message->msg_type, message->payload_size);
+    DEBUG_LOG("Sent message type %d, size %d via UDP", message->msg_type,
+              message->payload_size);
+    return 0;
+}
+
+// Poll the datagram socket for a complete control message.
+// Returns 0 with the message filled in, 1 when nothing is pending.
+static int udp_try_receive(transport_message_t* message) {
+    if (transport_socket.udp_fd < 0) {
+        return 1;
+    }
+
+    char datagram[sizeof(transport_header_t) + UDP_MAX_PAYLOAD];
+    struct sockaddr_in sender;
+    socklen_t sender_len = sizeof(sender);
+
+    ssize_t n = recvfrom(transport_socket.udp_fd, datagram, sizeof(datagram),
+                         MSG_DONTWAIT, (struct sockaddr*)&sender, &sender_len);
+    if (n < 0) {
+        return 1;
+    }
+
+    transport_header_t header;
+    if ((size_t)n < sizeof(header)) {
+        DEBUG_LOG("Runt datagram of %zd bytes dropped", n);
+        return 1;
+    }
+    memcpy(&header, datagram, sizeof(header));
+
+    if (header.magic != KORRA_MSG_MAGIC ||
+        header.version != KORRA_PROTOCOL_VERSION ||
+        sizeof(header) + header.payload_size != (size_t)n) {
+        DEBUG_LOG("Malformed datagram dropped");
+        return 1;
+    }
+
+    if (header.payload_size > 0 &&
+        korra_crc32c(datagram + sizeof(header), header.payload_size) != header.checksum) {
+        DEBUG_LOG("Datagram checksum mismatch, dropped");
+        return 1;
+    }
+
+    // Remember the sender so server-side heartbeats have a return path
+    transport_socket.udp_peer = sender;
+    transport_socket.udp_peer_known = true;
+
+    message->msg_type = header.msg_type;
+    message->channel = (uint8_t)(header.reserved >> TRANSPORT_CHANNEL_SHIFT);
+    message->payload_size = header.payload_size;
+    message->buffer = NULL;
+    message->payload = NULL;
+
+    if (header.payload_size > 0) {
+        message->buffer = korra_buf_alloc(header.payload_size);
+        if (!message->buffer) {
+            return 1;
+        }
+        memcpy(korra_buf_data(message->buffer), datagram + sizeof(header),
+               header.payload_size);
+        message->payload = korra_buf_data(message->buffer);
+    }
+
+    korra_stats_message_received(message->msg_type, message->payload_size);
+    DEBUG_LOG("Received message type %d, size %d via UDP", message->msg_type,
+              message->payload_size);
     return 0;
 }
 
 int transport_send(const transport_message_t* message) {
+    // Small control messages take the datagram fast path so a bulk
+    // transfer on the stream can't delay them
+    if (udp_eligible(message) && udp_send(message) == 0) {
+        return 0;
+    }
+
     if (!transport_socket.is_connected) {
         DEBUG_LOG("Cannot send message, not connected");
         return -1;
     }
-    
-    // Prepare header
+
+    return transport_send_fd(transport_socket.socket_fd, message);
+}
+
+int transport_send_batch_fd(int fd, const transport_message_t* messages, int count) {
+    if (!messages || count < 0) {
+        return -1;
+    }
+
+    // Coalesce up to IOV_MAX/2 messages (two iovec entries each) into
+    // a single writev so heartbeat-heavy links pay one syscall for the
+    // whole batch
+    int sent = 0;
+    while (sent < count) {
+        transport_header_t headers[IOV_MAX / 2];
+        struct iovec iov[IOV_MAX];
+        int chunk = count - sent;
+        if (chunk > (int)(IOV_MAX / 2)) {
+            chunk = IOV_MAX / 2;
+        }
+
+        int iov_count = 0;
+        for (int i = 0; i < chunk; i++) {
+            const transport_message_t* message = &messages[sent + i];
+            prepare_header(&headers[i], message);
+
+            iov[iov_count].iov_base = &headers[i];
+            iov[iov_count].iov_len = sizeof(headers[i]);
+            iov_count++;
+
+            if (message->payload_size > 0) {
+                iov[iov_count].iov_base = message->payload;
+                iov[iov_count].iov_len = message->payload_size;
+                iov_count++;
+            }
+        }
+
+        if (writev_all(fd, iov, iov_count) != 0) {
+            return -1;
+        }
+
+        for (int i = 0; i < chunk; i++) {
+            korra_stats_message_sent(messages[sent + i].msg_type,
+                                     messages[sent + i].payload_size);
+        }
+        sent += chunk;
+    }
+
+    DEBUG_LOG("Sent batch of %d messages", count);
+    return 0;
+}
+
+// Send one raw frame with explicit flag bits (stream framing). No
+// compression pass: chunks are already sized for the pool.
+static int send_frame(int fd, uint8_t msg_type, uint16_t flags,
+                      const void* payload, uint32_t payload_size) {
     transport_header_t header;
     header.magic = KORRA_MSG_MAGIC;
     header.version = KORRA_PROTOCOL_VERSION;
-    header.msg_type = message->msg_type;
-    header.payload_size = message->payload_size;
-    
-    // Send header
-    if (send(transport_socket.socket_fd, &header, sizeof(header), 0) != sizeof(header)) {
-        perror("Failed to send message header");
+    header.msg_type = msg_type;
+    header.reserved = flags;
+    header.payload_size = payload_size;
+    header.checksum = payload_size > 0 ? korra_crc32c(payload, payload_size) : 0;
+
+    struct iovec iov[2];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = (void*)payload;
+    iov[1].iov_len = payload_size;
+
+    return writev_all(fd, iov, payload_size > 0 ? 2 : 1);
+}
+
+int transport_send_stream_fd(int fd, uint8_t msg_type, uint64_t total_size,
+                             transport_stream_reader_t reader, void* ctx) {
+    if (!reader) {
         return -1;
     }
-    
-    // Send payload
+
+    // Open the stream; the begin frame carries the total size so the
+    // receiver can track progress and preallocate if it wants to
+    uint64_t total = total_size;
+    if (send_frame(fd, msg_type, TRANSPORT_FLAG_STREAM_BEGIN, &total, sizeof(total)) != 0) {
+        return -1;
+    }
+
+    if (total_size == 0) {
+        return send_frame(fd, msg_type,
+                          TRANSPORT_FLAG_STREAM_CHUNK | TRANSPORT_FLAG_STREAM_END,
+                          NULL, 0);
+    }
+
+    // One pool buffer is the only memory this send ever holds
+    korra_buf_t* chunk = korra_buf_alloc(TRANSPORT_STREAM_CHUNK_SIZE);
+    if (!chunk) {
+        return -1;
+    }
+
+    uint64_t offset = 0;
+    int result = 0;
+
+    while (offset < total_size) {
+        size_t want = total_size - offset < TRANSPORT_STREAM_CHUNK_SIZE
+                          ? (size_t)(total_size - offset)
+                          : TRANSPORT_STREAM_CHUNK_SIZE;
+        long got = reader(ctx, korra_buf_data(chunk), want);
+        if (got <= 0 || (uint64_t)got > want) {
+            ERROR_LOG("Stream reader failed at offset %llu of %llu",
+                      (unsigned long long)offset, (unsigned long long)total_size);
+            result = -1;
+            break;
+        }
+
+        uint16_t flags = TRANSPORT_FLAG_STREAM_CHUNK;
+        if (offset + (uint64_t)got == total_size) {
+            flags |= TRANSPORT_FLAG_STREAM_END;
+        }
+
+        if (send_frame(fd, msg_type, flags, korra_buf_data(chunk), (uint32_t)got) != 0) {
+            result = -1;
+            break;
+        }
+        offset += (uint64_t)got;
+    }
+
+    korra_buf_release(chunk);
+    if (result == 0) {
+        DEBUG_LOG("Streamed %llu bytes in %llu chunks",
+                  (unsigned long long)total_size,
+                  (unsigned long long)((total_size + TRANSPORT_STREAM_CHUNK_SIZE - 1) /
+                                       TRANSPORT_STREAM_CHUNK_SIZE));
+    }
+    return result;
+}
+
+// ---- Connection multiplexing ----
+//
+// Between data centers a handful of pinned TCP links carry every
+// logical flow, and a frame written is a frame committed - so a big
+// sync queued first starves the job results behind it. The mux parks
+// outbound frames per channel and a deficit round-robin scheduler
+// interleaves them: each round a channel earns weight * quantum bytes
+// of credit and sends whole frames while the credit covers them.
+// Fairness granularity is one frame, so bulk flows should ship
+// quantum-sized frames (or use the chunked stream path).
+
+// One parked frame, stored fully framed (header + payload)
+typedef struct mux_frame {
+    korra_buf_t* buf;
+    uint32_t size;
+    uint8_t msg_type;
+    uint32_t payload_size;
+    struct mux_frame* next;
+} mux_frame_t;
+
+typedef struct {
+    mux_frame_t* head;
+    mux_frame_t* tail;
+    int weight;
+    int64_t deficit;
+} mux_channel_t;
+
+typedef struct {
+    mux_channel_t channels[TRANSPORT_MUX_CHANNELS];
+} mux_state_t;
+
+// Allocated on first use per connection; like the recv slots, each fd
+// is driven by one thread at a time so there is no locking
+static mux_state_t* mux_states[MAX_TRACKED_FDS];
+
+static mux_state_t* mux_state_for(int fd) {
+    if (fd < 0 || fd >= MAX_TRACKED_FDS) {
+        return NULL;
+    }
+    if (!mux_states[fd]) {
+        mux_states[fd] = calloc(1, sizeof(mux_state_t));
+        if (!mux_states[fd]) {
+            ERROR_LOG("Failed to allocate mux state for fd %d", fd);
+            return NULL;
+        }
+        for (int i = 0; i < TRANSPORT_MUX_CHANNELS; i++) {
+            mux_states[fd]->channels[i].weight = 1;
+        }
+    }
+    return mux_states[fd];
+}
+
+int transport_mux_send_fd(int fd, uint8_t channel, const transport_message_t* message) {
+    if (channel >= TRANSPORT_MUX_CHANNELS) {
+        return -1;
+    }
+    mux_state_t* mux = mux_state_for(fd);
+    if (!mux) {
+        return -1;
+    }
+
+    mux_frame_t* frame = malloc(sizeof(mux_frame_t));
+    if (!frame) {
+        return -1;
+    }
+
+    // Frame the message now, with the channel id in the reserved high
+    // byte, so the flush path is a pure byte mover
+    frame->size = (uint32_t)sizeof(transport_header_t) + message->payload_size;
+    frame->buf = korra_buf_alloc(frame->size);
+    if (!frame->buf) {
+        free(frame);
+        return -1;
+    }
+
+    transport_header_t header;
+    prepare_header(&header, message);
+    header.reserved |= (uint16_t)channel << TRANSPORT_CHANNEL_SHIFT;
+
+    uint8_t* data = korra_buf_data(frame->buf);
+    memcpy(data, &header, sizeof(header));
     if (message->payload_size > 0) {
-        if (send(transport_socket.socket_fd, message->payload, message->payload_size, 0) != message->payload_size) {
-            perror("Failed to send message payload");
-            return -1;
+        memcpy(data + sizeof(header), message->payload, message->payload_size);
+    }
+    frame->msg_type = message->msg_type;
+    frame->payload_size = message->payload_size;
+    frame->next = NULL;
+
+    mux_channel_t* ch = &mux->channels[channel];
+    if (ch->tail) {
+        ch->tail->next = frame;
+    } else {
+        ch->head = frame;
+    }
+    ch->tail = frame;
+
+    DEBUG_LOG("Queued message type %d on channel %d, size %d",
+              message->msg_type, channel, message->payload_size);
+    return 0;
+}
+
+void transport_mux_set_weight(int fd, uint8_t channel, int weight) {
+    if (channel >= TRANSPORT_MUX_CHANNELS) {
+        return;
+    }
+    mux_state_t* mux = mux_state_for(fd);
+    if (!mux) {
+        return;
+    }
+
+    if (weight < 1) {
+        weight = 1;
+    } else if (weight > 64) {
+        weight = 64;
+    }
+    mux->channels[channel].weight = weight;
+}
+
+int transport_mux_flush_fd(int fd) {
+    if (fd < 0 || fd >= MAX_TRACKED_FDS || !mux_states[fd]) {
+        return 0;
+    }
+    mux_state_t* mux = mux_states[fd];
+
+    bool pending = true;
+    while (pending) {
+        pending = false;
+
+        for (int i = 0; i < TRANSPORT_MUX_CHANNELS; i++) {
+            mux_channel_t* ch = &mux->channels[i];
+            if (!ch->head) {
+                continue;
+            }
+
+            // Earn this round's credit, then send whole frames until
+            // the credit runs out or the channel drains
+            ch->deficit += (int64_t)ch->weight * TRANSPORT_MUX_QUANTUM;
+            while (ch->head && (int64_t)ch->head->size <= ch->deficit) {
+                mux_frame_t* frame = ch->head;
+                struct iovec iov = { korra_buf_data(frame->buf), frame->size };
+
+                if (writev_all(fd, &iov, 1) != 0) {
+                    return -1;
+                }
+
+                ch->deficit -= frame->size;
+                korra_stats_message_sent(frame->msg_type, frame->payload_size);
+                ch->head = frame->next;
+                if (!ch->head) {
+                    ch->tail = NULL;
+                }
+                korra_buf_release(frame->buf);
+                free(frame);
+            }
+
+            if (ch->head) {
+                pending = true;     // big frame still saving credit
+            } else {
+                ch->deficit = 0;    // idle channels bank nothing
+            }
         }
     }
-    
-    DEBUG_LOG("Sent message type %d, size %d", message->msg_type, message->payload_size);
+
     return 0;
 }
 
-int transport_receive(transport_message_t* message) {
+void transport_mux_reset_fd(int fd) {
+    if (fd < 0 || fd >= MAX_TRACKED_FDS || !mux_states[fd]) {
+        return;
+    }
+
+    mux_state_t* mux = mux_states[fd];
+    for (int i = 0; i < TRANSPORT_MUX_CHANNELS; i++) {
+        mux_frame_t* frame = mux->channels[i].head;
+        while (frame) {
+            mux_frame_t* next = frame->next;
+            korra_buf_release(frame->buf);
+            free(frame);
+            frame = next;
+        }
+    }
+    free(mux);
+    mux_states[fd] = NULL;
+}
+
+int transport_send_batch(const transport_message_t* messages, int count) {
     if (!transport_socket.is_connected) {
-        DEBUG_LOG("Cannot receive message, not connected");
+        DEBUG_LOG("Cannot send batch, not connected");
         return -1;
     }
-    
-    // Receive header
+
+    return transport_send_batch_fd(transport_socket.socket_fd, messages, count);
+}
+
+// Per-connection receive state: a frame is accumulated across recv()
+// calls, so TCP segmentation on WAN links no longer produces spurious
+// header errors. Each fd is read by a single worker at a time (the
+// event loop arms connections EPOLLONESHOT), so slots need no locking.
+typedef struct {
     transport_header_t header;
-    ssize_t bytes_received = recv(transport_socket.socket_fd, &header, sizeof(header), 0);
-    
-    if (bytes_received != sizeof(header)) {
-        if (bytes_received == 0) {
+    size_t header_bytes;    // header bytes accumulated so far
+    size_t payload_bytes;   // payload bytes accumulated so far
+    korra_buf_t* buffer;    // in-flight payload buffer
+} recv_state_t;
+
+static recv_state_t recv_states[MAX_TRACKED_FDS];
+
+// Per-connection inbound stream progress
+typedef struct {
+    bool active;
+    uint8_t msg_type;
+    uint64_t total;
+    uint64_t offset;
+} stream_state_t;
+
+static stream_state_t stream_states[MAX_TRACKED_FDS];
+
+static transport_stream_handler_t stream_handler;
+static void* stream_handler_ctx;
+
+void transport_set_stream_handler(transport_stream_handler_t handler, void* ctx) {
+    stream_handler = handler;
+    stream_handler_ctx = ctx;
+}
+
+// Consume one stream frame. The chunk data lives in the recv slot's
+// pool buffer, which the caller resets (and thus recycles) afterwards.
+static void handle_stream_frame(int fd, const transport_header_t* header,
+                                korra_buf_t* buffer) {
+    stream_state_t* stream = &stream_states[fd];
+
+    if (header->reserved & TRANSPORT_FLAG_STREAM_BEGIN) {
+        if (header->payload_size != sizeof(uint64_t) || !buffer) {
+            DEBUG_LOG("Malformed stream begin frame dropped");
+            stream->active = false;
+            return;
+        }
+        memcpy(&stream->total, korra_buf_data(buffer), sizeof(uint64_t));
+        stream->msg_type = header->msg_type;
+        stream->offset = 0;
+        stream->active = true;
+        DEBUG_LOG("Stream of %llu bytes opened on fd %d",
+                  (unsigned long long)stream->total, fd);
+        return;
+    }
+
+    if (!stream->active) {
+        DEBUG_LOG("Stream chunk without an open stream dropped");
+        return;
+    }
+
+    bool last = (header->reserved & TRANSPORT_FLAG_STREAM_END) != 0;
+
+    if (stream_handler) {
+        const void* data = buffer ? korra_buf_data(buffer) : NULL;
+        if (stream_handler(stream->msg_type, stream->offset, stream->total,
+                           data, header->payload_size, last,
+                           stream_handler_ctx) != 0) {
+            DEBUG_LOG("Stream handler aborted stream on fd %d", fd);
+            stream->active = false;
+            return;
+        }
+    }
+
+    stream->offset += header->payload_size;
+    if (last) {
+        if (stream->offset != stream->total) {
+            WARN_LOG("Stream ended at %llu of %llu bytes",
+                     (unsigned long long)stream->offset,
+                     (unsigned long long)stream->total);
+        }
+        stream->active = false;
+    }
+}
+
+// Reset a connection's accumulation state, dropping any partial frame
+static void recv_state_reset(recv_state_t* state) {
+    if (state->buffer) {
+        korra_buf_release(state->buffer);
+    }
+    memset(state, 0, sizeof(recv_state_t));
+}
+
+// Reset everything tied to a connection when it ends. Without this a
+// later connection reusing the fd would inherit an open stream and its
+// stale msg_type/offset, slipping past the no-open-stream guard.
+static void connection_state_reset(int fd) {
+    recv_state_reset(&recv_states[fd]);
+    memset(&stream_states[fd], 0, sizeof(stream_state_t));
+}
+
+// Receive into buf until `needed` bytes are accumulated in *have.
+// Returns 0 when complete, otherwise a transport return code.
+static int recv_accumulate(int fd, void* buf, size_t needed, size_t* have) {
+    while (*have < needed) {
+        ssize_t n = recv(fd, (char*)buf + *have, needed - *have, 0);
+        if (n == 0) {
             DEBUG_LOG("Connection closed by peer");
-            transport_socket.is_connected = false;
-        } else {
-            perror("Failed to receive message header");
+            return TRANSPORT_CLOSED;
         }
-        return -1;
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return TRANSPORT_WOULDBLOCK;
+            }
+            perror("Failed to receive message data");
+            return -1;
+        }
+        *have += (size_t)n;
     }
-    
-    // Validate header
-    if (header.magic != KORRA_MSG_MAGIC) {
-        DEBUG_LOG("Invalid message magic: %08x", header.magic);
+    return 0;
+}
+
+// Internal receive_frame() result: a stream frame was consumed by the
+// handler and the caller should read the next frame
+#define FRAME_STREAM_CONSUMED 1
+
+static int receive_frame(int fd, transport_message_t* message) {
+    if (fd < 0 || fd >= MAX_TRACKED_FDS) {
+        DEBUG_LOG("Connection fd %d outside tracked range", fd);
         return -1;
     }
-    
-    if (header.version != KORRA_PROTOCOL_VERSION) {
-        DEBUG_LOG("Unsupported protocol version: %d", header.version);
-        return -1;
+
+    recv_state_t* state = &recv_states[fd];
+
+    // Accumulate the header
+    int result = recv_accumulate(fd, &state->header, sizeof(state->header),
+                                 &state->header_bytes);
+    if (result != 0) {
+        if (result != TRANSPORT_WOULDBLOCK) {
+            connection_state_reset(fd);
+        }
+        return result;
     }
-    
-    // Copy header fields to message
-    message->msg_type = header.msg_type;
-    message->payload_size = header.payload_size;
-    
-    // Allocate and receive payload if present
-    if (header.payload_size > 0) {
-        message->payload = malloc(header.payload_size);
-        if (!message->payload) {
-            DEBUG_LOG("Failed to allocate %d bytes for payload", header.payload_size);
+
+    // Validate the header once, when it first completes
+    if (!state->buffer && state->payload_bytes == 0) {
+        if (state->header.magic != KORRA_MSG_MAGIC) {
+            DEBUG_LOG("Invalid message magic: %08x", state->header.magic);
+            connection_state_reset(fd);
             return -1;
         }
-        
-        bytes_received = recv(transport_socket.socket_fd, message->payload, header.payload_size, 0);
-        if (bytes_received != header.payload_size) {
-            if (bytes_received == 0) {
-                DEBUG_LOG("Connection closed by peer during payload receive");
-                transport_socket.is_connected = false;
-            } else {
-                perror("Failed to receive message payload");
+
+        if (state->header.version != KORRA_PROTOCOL_VERSION) {
+            DEBUG_LOG("Unsupported protocol version: %d", state->header.version);
+            connection_state_reset(fd);
+            return -1;
+        }
+    }
+
+    // Accumulate the payload if present
+    if (state->header.payload_size > 0) {
+        if (!state->buffer) {
+            state->buffer = korra_buf_alloc(state->header.payload_size);
+            if (!state->buffer) {
+                DEBUG_LOG("Failed to allocate %d bytes for payload", state->header.payload_size);
+                connection_state_reset(fd);
+                return -1;
             }
-            free(message->payload);
-            message->payload = NULL;
+        }
+
+        result = recv_accumulate(fd, korra_buf_data(state->buffer),
+                                 state->header.payload_size, &state->payload_bytes);
+        if (result != 0) {
+            if (result != TRANSPORT_WOULDBLOCK) {
+                connection_state_reset(fd);
+            }
+            return result;
+        }
+    }
+
+    // Verify payload integrity before handing the frame up: TCP's own
+    // checksum has let NIC-level corruption through before
+    if (state->header.payload_size > 0) {
+        uint32_t checksum = korra_crc32c(korra_buf_data(state->buffer),
+                                         state->header.payload_size);
+        if (checksum != state->header.checksum) {
+            DEBUG_LOG("Payload checksum mismatch: %08x != %08x",
+                      checksum, state->header.checksum);
+            connection_state_reset(fd);
             return -1;
         }
-    } else {
-        message->payload = NULL;
     }
-    
+
+    // Stream frames are consumed here and never surface as messages,
+    // so control traffic interleaves with a sync in flight
+    if (state->header.reserved &
+        (TRANSPORT_FLAG_STREAM_BEGIN | TRANSPORT_FLAG_STREAM_CHUNK)) {
+        handle_stream_frame(fd, &state->header, state->buffer);
+        recv_state_reset(state);
+        return FRAME_STREAM_CONSUMED;
+    }
+
+    // Frame complete: hand it off and clear the slot for the next one
+    message->msg_type = state->header.msg_type;
+    message->channel = (uint8_t)(state->header.reserved >> TRANSPORT_CHANNEL_SHIFT);
+    message->payload_size = state->header.payload_size;
+    message->buffer = state->buffer;
+    message->payload = state->buffer ? korra_buf_data(state->buffer) : NULL;
+
+    // Transparently decompress flagged payloads
+    if ((state->header.reserved & TRANSPORT_FLAG_COMPRESSED) && message->buffer) {
+        uint8_t* data = korra_buf_data(message->buffer);
+        uint32_t original_size;
+
+        if (message->payload_size < sizeof(uint32_t)) {
+            DEBUG_LOG("Compressed payload too short: %d bytes", message->payload_size);
+            connection_state_reset(fd);
+            return -1;
+        }
+        memcpy(&original_size, data, sizeof(uint32_t));
+
+        korra_buf_t* decompressed = korra_buf_alloc(original_size);
+        if (!decompressed) {
+            connection_state_reset(fd);
+            return -1;
+        }
+
+        long size = korra_decompress(data + sizeof(uint32_t),
+                                     message->payload_size - sizeof(uint32_t),
+                                     korra_buf_data(decompressed), original_size);
+        if (size != (long)original_size) {
+            DEBUG_LOG("Failed to decompress payload (%ld != %u)", size, original_size);
+            korra_buf_release(decompressed);
+            connection_state_reset(fd);
+            return -1;
+        }
+
+        korra_buf_release(message->buffer);
+        message->buffer = decompressed;
+        message->payload = korra_buf_data(decompressed);
+        message->payload_size = original_size;
+        DEBUG_LOG("Decompressed payload %d -> %u bytes",
+                  state->header.payload_size, original_size);
+    }
+
+    memset(state, 0, sizeof(recv_state_t));
+
+    korra_stats_message_received(message->msg_type, message->payload_size);
     DEBUG_LOG("Received message type %d, size %d", message->msg_type, message->payload_size);
     return 0;
 }
 
+int transport_receive_fd(int fd, transport_message_t* message) {
+    while (true) {
+        int result = receive_frame(fd, message);
+        if (result != FRAME_STREAM_CONSUMED) {
+            return result;
+        }
+    }
+}
+
+void transport_message_free(transport_message_t* message) {
+    if (!message || !message->payload) {
+        return;
+    }
+
+    if (message->buffer) {
+        korra_buf_release(message->buffer);
+    } else {
+        free(message->payload);
+    }
+
+    message->payload = NULL;
+    message->buffer = NULL;
+}
+
+int transport_receive(transport_message_t* message) {
+    // Drain pending datagrams first: fast-path control messages are
+    // latency sensitive and never have to wait behind stream data
+    if (udp_try_receive(message) == 0) {
+        return 0;
+    }
+
+    if (!transport_socket.is_connected) {
+        DEBUG_LOG("Cannot receive message, not connected");
+        return -1;
+    }
+
+    int result = transport_receive_fd(transport_socket.socket_fd, message);
+    if (result == TRANSPORT_CLOSED) {
+        transport_socket.is_connected = false;
+    }
+    return result;
+}
+
+int transport_listen_fd(void) {
+    if (!transport_socket.is_server) {
+        return -1;
+    }
+    return transport_socket.socket_fd;
+}
+
+int transport_udp_fd(void) {
+    return transport_socket.udp_fd;
+}
+
 int transport_accept(int* client_fd) {
     if (!transport_socket.is_server) {
         DEBUG_LOG("Cannot accept connections, not a server");
@@ -212,6 +1082,11 @@ void transport_close() {
         close(transport_socket.socket_fd);
         transport_socket.socket_fd = -1;
     }
-    
+
+    if (transport_socket.udp_fd >= 0) {
+        close(transport_socket.udp_fd);
+        transport_socket.udp_fd = -1;
+    }
+
     transport_socket.is_connected = false;
 }
\ No newline at end of file
@@ -3,33 +3,102 @@
  * @brief Tracing and fail-safe interrupt handling for KORRA
  */
 
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <signal.h>
 #include <execinfo.h>
 #include <unistd.h>
+#include <pthread.h>
+#define KORRA_LOG_MODULE KORRA_MODULE_TOOLS
 #include "../include/debug.h"
 
 // Maximum stack frames to trace
 #define MAX_STACK_FRAMES 64
 
-// Signal handler for crashes
+// Subsystem dumpers run inside the crash handler
+#define MAX_CRASH_DUMPERS 8
+
+static debug_crash_dumper_t crash_dumpers[MAX_CRASH_DUMPERS];
+static int num_crash_dumpers;
+
+void debug_write_str(int fd, const char* str) {
+    size_t len = 0;
+    while (str[len]) {
+        len++;
+    }
+
+    // Best effort: a crash dump can't do anything about a failed write
+    while (len > 0) {
+        ssize_t n = write(fd, str, len);
+        if (n <= 0) {
+            return;
+        }
+        str += n;
+        len -= (size_t)n;
+    }
+}
+
+void debug_write_dec(int fd, long long value) {
+    char digits[24];
+    int i = sizeof(digits);
+    unsigned long long magnitude;
+
+    if (value < 0) {
+        debug_write_str(fd, "-");
+        magnitude = (unsigned long long)(-(value + 1)) + 1;
+    } else {
+        magnitude = (unsigned long long)value;
+    }
+
+    do {
+        digits[--i] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0 && i > 0);
+
+    while (i < (int)sizeof(digits)) {
+        char c = digits[i++];
+        if (write(fd, &c, 1) <= 0) {
+            return;
+        }
+    }
+}
+
+void debug_register_crash_dumper(debug_crash_dumper_t dumper) {
+    for (int i = 0; i < num_crash_dumpers; i++) {
+        if (crash_dumpers[i] == dumper) {
+            return;
+        }
+    }
+    if (num_crash_dumpers < MAX_CRASH_DUMPERS) {
+        crash_dumpers[num_crash_dumpers++] = dumper;
+    }
+}
+
+// Signal handler for crashes. Everything here must be async-signal-
+// safe: only write()-based output (no stdio, no localtime, no locks)
+// and _exit() rather than exit(), so a SIGSEGV mid-malloc or mid-log
+// can't deadlock the handler and wedge the node until the watchdog
+// fires. backtrace_symbols_fd() writes straight to the fd without
+// allocating.
 static void crash_handler(int sig) {
     void* stack_frames[MAX_STACK_FRAMES];
     int frame_count;
-    
-    // Get stack trace
+
+    debug_write_str(STDERR_FILENO, "\n*** KORRA crash: caught signal ");
+    debug_write_dec(STDERR_FILENO, sig);
+    debug_write_str(STDERR_FILENO, " ***\nStack trace:\n");
+
     frame_count = backtrace(stack_frames, MAX_STACK_FRAMES);
-    
-    // Log crash information
-    FATAL_LOG("Caught signal %d, process crashing", sig);
-    
-    // Print stack trace to stderr
-    fprintf(stderr, "Stack trace:\n");
     backtrace_symbols_fd(stack_frames, frame_count, STDERR_FILENO);
-    
-    // Exit process
-    exit(1);
+
+    // Let each subsystem say what was in flight
+    for (int i = 0; i < num_crash_dumpers; i++) {
+        crash_dumpers[i](STDERR_FILENO);
+    }
+
+    _exit(128 + sig);
 }
 
 // Initialize debug and crash handling
@@ -0,0 +1,243 @@
+/**
+ * @file log.c
+ * @brief Asynchronous logging backend for KORRA
+ *
+ * Each logging thread owns a single-producer single-consumer ring of
+ * preformatted records; the producer side is a vsnprintf plus two
+ * relaxed atomic ops, so hot paths never pay for localtime(), strftime()
+ * or unbuffered stderr writes. One drain thread walks the registered
+ * rings, renders timestamps (cached per second) and does all the I/O.
+ * When the ring is full the record is dropped and counted rather than
+ * blocking the producer; drops are reported by the drain thread.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+#define KORRA_LOG_MODULE KORRA_MODULE_TOOLS
+#include "../include/log.h"
+#include "../include/debug.h"
+
+// Records per per-thread ring (power of two)
+#define LOG_RING_SIZE 1024
+
+// Maximum registered logging threads
+#define MAX_LOG_THREADS 128
+
+// Preformatted message bytes per record
+#define LOG_MSG_MAX 224
+
+// One preformatted log record
+typedef struct {
+    struct timespec timestamp;
+    log_level_t level;
+    const char* file;   // NULL = no file:line tag
+    int line;
+    char message[LOG_MSG_MAX];
+} log_record_t;
+
+// Per-thread SPSC ring
+typedef struct {
+    log_record_t records[LOG_RING_SIZE];
+    atomic_size_t head;     // consumer position
+    atomic_size_t tail;     // producer position
+    atomic_size_t dropped;  // records lost to a full ring
+} log_ring_t;
+
+// Backend state. Ring pointers are published with a release store
+// after the ring is fully initialized, so the drain thread never sees
+// a slot counted by num_rings but not yet filled in.
+static log_ring_t* _Atomic rings[MAX_LOG_THREADS];
+static atomic_int num_rings;
+static atomic_bool log_running;
+static pthread_t drain_thread;
+
+// Each thread finds its ring through TLS
+static __thread log_ring_t* tls_ring;
+
+// Runtime per-module level floors. Zero is LOG_LEVEL_DEBUG, so every
+// site the compile-time floor kept is emitted until a module is
+// explicitly quietened (or loudened back).
+unsigned char korra_log_module_levels[KORRA_MODULE_COUNT];
+
+void korra_log_set_module_level(log_module_t module, log_level_t level) {
+    if (module < 0 || module >= KORRA_MODULE_COUNT) {
+        return;
+    }
+    korra_log_module_levels[module] = (unsigned char)level;
+}
+
+static const char* level_names[] = { "DEBUG", "INFO", "WARN", "ERROR", "FATAL" };
+
+// Render a wall-clock timestamp, caching the formatted second
+static void format_timestamp(const struct timespec* ts, char* out, size_t out_size) {
+    static time_t cached_second;
+    static char cached_str[20];
+
+    if (ts->tv_sec != cached_second) {
+        struct tm tm_info;
+        localtime_r(&ts->tv_sec, &tm_info);
+        strftime(cached_str, sizeof(cached_str), "%Y-%m-%d %H:%M:%S", &tm_info);
+        cached_second = ts->tv_sec;
+    }
+
+    snprintf(out, out_size, "%s", cached_str);
+}
+
+// Write one record to stderr in the same shape the old macros used
+static void emit_record(const log_record_t* record) {
+    char time_str[20];
+    format_timestamp(&record->timestamp, time_str, sizeof(time_str));
+
+    if (record->file) {
+        fprintf(stderr, "[%s][%s][%s:%d] %s\n", time_str,
+                level_names[record->level], record->file, record->line,
+                record->message);
+    } else {
+        fprintf(stderr, "[%s][%s] %s\n", time_str,
+                level_names[record->level], record->message);
+    }
+}
+
+// Drain every ring once; returns the number of records emitted
+static int drain_rings(void) {
+    int emitted = 0;
+    int count = atomic_load_explicit(&num_rings, memory_order_acquire);
+
+    for (int i = 0; i < count; i++) {
+        log_ring_t* ring = atomic_load_explicit(&rings[i], memory_order_acquire);
+        if (!ring) {
+            // num_rings is bumped before the slot is filled; a failed
+            // calloc can also leave a permanent hole
+            continue;
+        }
+
+        size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+        while (head != tail) {
+            emit_record(&ring->records[head % LOG_RING_SIZE]);
+            head++;
+            emitted++;
+        }
+        atomic_store_explicit(&ring->head, head, memory_order_release);
+
+        size_t dropped = atomic_exchange_explicit(&ring->dropped, 0, memory_order_relaxed);
+        if (dropped > 0) {
+            fprintf(stderr, "[log] dropped %zu records from a full ring\n", dropped);
+        }
+    }
+
+    return emitted;
+}
+
+// Drain thread: all timestamp formatting and I/O happens here
+static void* log_drain_worker(void* arg) {
+    (void)arg;
+    debug_set_thread_name("korra-log");
+
+    while (atomic_load_explicit(&log_running, memory_order_acquire)) {
+        if (drain_rings() == 0) {
+            usleep(1000);
+        }
+    }
+
+    // Final sweep so shutdown doesn't lose buffered records
+    drain_rings();
+    return NULL;
+}
+
+// Get or register the calling thread's ring
+static log_ring_t* get_ring(void) {
+    if (tls_ring) {
+        return tls_ring;
+    }
+
+    int slot = atomic_fetch_add_explicit(&num_rings, 1, memory_order_relaxed);
+    if (slot >= MAX_LOG_THREADS) {
+        atomic_fetch_sub_explicit(&num_rings, 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    log_ring_t* ring = calloc(1, sizeof(log_ring_t));
+    if (!ring) {
+        atomic_fetch_sub_explicit(&num_rings, 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    atomic_store_explicit(&rings[slot], ring, memory_order_release);
+    tls_ring = ring;
+    return ring;
+}
+
+int korra_log_init(void) {
+    if (atomic_load(&log_running)) {
+        return 0;
+    }
+
+    atomic_store(&log_running, true);
+    if (pthread_create(&drain_thread, NULL, log_drain_worker, NULL) != 0) {
+        perror("Failed to create log drain thread");
+        atomic_store(&log_running, false);
+        return -1;
+    }
+
+    return 0;
+}
+
+void korra_log_shutdown(void) {
+    if (!atomic_load(&log_running)) {
+        return;
+    }
+
+    atomic_store(&log_running, false);
+    pthread_join(drain_thread, NULL);
+}
+
+void korra_log_write(log_level_t level, const char* file, int line, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+
+    log_ring_t* ring = atomic_load_explicit(&log_running, memory_order_acquire)
+                           ? get_ring()
+                           : NULL;
+
+    if (!ring) {
+        // Synchronous fallback: backend not running or out of ring slots
+        log_record_t record;
+        clock_gettime(CLOCK_REALTIME, &record.timestamp);
+        record.level = level;
+        record.file = file;
+        record.line = line;
+        vsnprintf(record.message, sizeof(record.message), fmt, args);
+        va_end(args);
+        emit_record(&record);
+        return;
+    }
+
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    if (tail - head >= LOG_RING_SIZE) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        va_end(args);
+        return;
+    }
+
+    log_record_t* record = &ring->records[tail % LOG_RING_SIZE];
+    clock_gettime(CLOCK_REALTIME, &record->timestamp);
+    record->level = level;
+    record->file = file;
+    record->line = line;
+    vsnprintf(record->message, sizeof(record->message), fmt, args);
+    va_end(args);
+
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
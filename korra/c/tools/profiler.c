@@ -0,0 +1,316 @@
+/**
+ * @file profiler.c
+ * @brief In-process sampling profiler with task-name attribution
+ *
+ * Production nodes can't be attached to external profilers, and the
+ * question asked most during incidents is "which task name is eating
+ * the pool". Workers publish the task they are running in a per-thread
+ * slot; a sampler thread periodically interrupts each registered
+ * thread with SIGPROF, whose handler snapshots the slot's task name
+ * and a backtrace() of the stack (the same machinery crash_handler()
+ * uses). The sampler folds the samples into a fixed table that dumps
+ * as flame-graph-ready lines: task-name;frame;...;frame count.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <signal.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "../include/profiler.h"
+#define KORRA_LOG_MODULE KORRA_MODULE_TOOLS
+#include "../include/debug.h"
+
+// Maximum registered threads
+#define MAX_PROFILED_THREADS 128
+
+// Stack frames captured per sample
+#define MAX_SAMPLE_FRAMES 32
+
+// Unique (task name, stack) pairs accumulated before samples are
+// folded into a catch-all overflow bucket
+#define MAX_UNIQUE_STACKS 1024
+
+// Microseconds the sampler waits for a signalled thread to finish
+// writing its sample before giving up on this tick
+#define SAMPLE_WAIT_US 2000
+
+// Sample handshake states
+enum { SAMPLE_IDLE = 0, SAMPLE_REQUESTED, SAMPLE_READY };
+
+// Per-thread slot. The owning thread writes task_name under an odd/even
+// sequence counter so the sampler can detect torn reads; the SIGPROF
+// handler fills frames[] and flips sample_state to READY.
+typedef struct {
+    pthread_t thread;
+    atomic_bool used;
+    atomic_uint seq;            // odd while task_name is being written
+    char task_name[64];
+    atomic_int sample_state;
+    char sampled_name[64];      // name captured inside the handler
+    void* frames[MAX_SAMPLE_FRAMES];
+    int frame_count;
+} profile_slot_t;
+
+// One folded (task name, stack) bucket
+typedef struct {
+    char name[64];
+    void* frames[MAX_SAMPLE_FRAMES];
+    int frame_count;
+    uint64_t count;
+} stack_bucket_t;
+
+static profile_slot_t slots[MAX_PROFILED_THREADS];
+static atomic_int num_slots;
+static __thread profile_slot_t* tls_slot;
+
+static stack_bucket_t buckets[MAX_UNIQUE_STACKS];
+static int num_buckets;
+static uint64_t overflow_samples;
+static pthread_mutex_t bucket_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static atomic_bool profiler_running;
+static pthread_t sampler_thread;
+static int sample_interval_ms = 10;
+
+// Crash dumper: the per-worker task names answer "what was in flight"
+// in a postmortem. Reads are racy but the process is dying anyway.
+static void profiler_crash_dump(int fd) {
+    debug_write_str(fd, "Worker tasks:\n");
+
+    int count = atomic_load_explicit(&num_slots, memory_order_relaxed);
+    for (int i = 0; i < count && i < MAX_PROFILED_THREADS; i++) {
+        if (!atomic_load_explicit(&slots[i].used, memory_order_relaxed)) {
+            continue;
+        }
+        debug_write_str(fd, "  worker ");
+        debug_write_dec(fd, i);
+        debug_write_str(fd, ": ");
+        debug_write_str(fd, slots[i].task_name[0] ? slots[i].task_name : "idle");
+        debug_write_str(fd, "\n");
+    }
+}
+
+int korra_profiler_thread_register(void) {
+    if (tls_slot) {
+        return 0;
+    }
+
+    debug_register_crash_dumper(profiler_crash_dump);
+
+    int index = atomic_fetch_add_explicit(&num_slots, 1, memory_order_relaxed);
+    if (index >= MAX_PROFILED_THREADS) {
+        atomic_fetch_sub_explicit(&num_slots, 1, memory_order_relaxed);
+        WARN_LOG("Profiler slot table full, thread will not be sampled");
+        return -1;
+    }
+
+    profile_slot_t* slot = &slots[index];
+    slot->thread = pthread_self();
+    atomic_store_explicit(&slot->sample_state, SAMPLE_IDLE, memory_order_relaxed);
+    atomic_store_explicit(&slot->used, true, memory_order_release);
+    tls_slot = slot;
+    return 0;
+}
+
+void korra_profiler_set_task(const char* name) {
+    profile_slot_t* slot = tls_slot;
+    if (!slot) {
+        return;
+    }
+
+    // Odd/even sequence so the handler can detect a half-written name
+    atomic_fetch_add_explicit(&slot->seq, 1, memory_order_release);
+    if (name) {
+        snprintf(slot->task_name, sizeof(slot->task_name), "%s", name);
+    } else {
+        slot->task_name[0] = '\0';
+    }
+    atomic_fetch_add_explicit(&slot->seq, 1, memory_order_release);
+}
+
+// SIGPROF handler: runs on the interrupted thread, so backtrace() sees
+// that thread's stack. Writes only to the thread's own slot.
+static void sample_handler(int sig) {
+    (void)sig;
+    profile_slot_t* slot = tls_slot;
+    if (!slot ||
+        atomic_load_explicit(&slot->sample_state, memory_order_acquire) != SAMPLE_REQUESTED) {
+        return;
+    }
+
+    unsigned seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    if (seq % 2 == 0) {
+        memcpy(slot->sampled_name, slot->task_name, sizeof(slot->sampled_name));
+        if (atomic_load_explicit(&slot->seq, memory_order_acquire) != seq) {
+            // Task switched mid-copy; attribute the sample to no task
+            slot->sampled_name[0] = '\0';
+        }
+    } else {
+        slot->sampled_name[0] = '\0';
+    }
+    slot->sampled_name[sizeof(slot->sampled_name) - 1] = '\0';
+
+    slot->frame_count = backtrace(slot->frames, MAX_SAMPLE_FRAMES);
+    atomic_store_explicit(&slot->sample_state, SAMPLE_READY, memory_order_release);
+}
+
+// Fold one sample into its bucket
+static void accumulate_sample(const profile_slot_t* slot) {
+    const char* name = slot->sampled_name[0] ? slot->sampled_name : "idle";
+
+    pthread_mutex_lock(&bucket_mutex);
+    for (int i = 0; i < num_buckets; i++) {
+        stack_bucket_t* bucket = &buckets[i];
+        if (bucket->frame_count == slot->frame_count &&
+            strcmp(bucket->name, name) == 0 &&
+            memcmp(bucket->frames, slot->frames,
+                   slot->frame_count * sizeof(void*)) == 0) {
+            bucket->count++;
+            pthread_mutex_unlock(&bucket_mutex);
+            return;
+        }
+    }
+
+    if (num_buckets < MAX_UNIQUE_STACKS) {
+        stack_bucket_t* bucket = &buckets[num_buckets++];
+        snprintf(bucket->name, sizeof(bucket->name), "%s", name);
+        memcpy(bucket->frames, slot->frames, slot->frame_count * sizeof(void*));
+        bucket->frame_count = slot->frame_count;
+        bucket->count = 1;
+    } else {
+        overflow_samples++;
+    }
+    pthread_mutex_unlock(&bucket_mutex);
+}
+
+// Sampler thread: one SIGPROF round per tick
+static void* sampler_worker(void* arg) {
+    (void)arg;
+    debug_set_thread_name("korra-prof");
+
+    while (atomic_load_explicit(&profiler_running, memory_order_acquire)) {
+        int count = atomic_load_explicit(&num_slots, memory_order_acquire);
+
+        for (int i = 0; i < count; i++) {
+            profile_slot_t* slot = &slots[i];
+            if (!atomic_load_explicit(&slot->used, memory_order_acquire)) {
+                continue;
+            }
+
+            atomic_store_explicit(&slot->sample_state, SAMPLE_REQUESTED,
+                                  memory_order_release);
+            if (pthread_kill(slot->thread, SIGPROF) != 0) {
+                // Thread is gone; stop sampling its slot
+                atomic_store_explicit(&slot->used, false, memory_order_release);
+                continue;
+            }
+
+            // Wait briefly for the handler; a tick is skippable
+            int waited = 0;
+            while (atomic_load_explicit(&slot->sample_state,
+                                        memory_order_acquire) != SAMPLE_READY &&
+                   waited < SAMPLE_WAIT_US) {
+                usleep(50);
+                waited += 50;
+            }
+
+            if (atomic_load_explicit(&slot->sample_state,
+                                     memory_order_acquire) == SAMPLE_READY) {
+                accumulate_sample(slot);
+            }
+            atomic_store_explicit(&slot->sample_state, SAMPLE_IDLE,
+                                  memory_order_release);
+        }
+
+        usleep(sample_interval_ms * 1000);
+    }
+
+    return NULL;
+}
+
+int korra_profiler_start(int interval_ms) {
+    if (atomic_load(&profiler_running)) {
+        return 0;
+    }
+
+    sample_interval_ms = interval_ms > 0 ? interval_ms : 10;
+
+    // glibc's first backtrace() call dlopens libgcc and allocates;
+    // taken inside the signal handler that could deadlock a thread
+    // sampled mid-malloc. Pay that cost here, before any SIGPROF fires.
+    void* prime[4];
+    backtrace(prime, 4);
+
+    // SA_RESTART so sampled syscalls resume instead of failing EINTR
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = sample_handler;
+    action.sa_flags = SA_RESTART;
+    if (sigaction(SIGPROF, &action, NULL) != 0) {
+        perror("Failed to install SIGPROF handler");
+        return -1;
+    }
+
+    atomic_store(&profiler_running, true);
+    if (pthread_create(&sampler_thread, NULL, sampler_worker, NULL) != 0) {
+        perror("Failed to create sampler thread");
+        atomic_store(&profiler_running, false);
+        return -1;
+    }
+
+    INFO_LOG("Profiler sampling every %d ms", sample_interval_ms);
+    return 0;
+}
+
+void korra_profiler_stop(void) {
+    if (!atomic_load(&profiler_running)) {
+        return;
+    }
+
+    atomic_store(&profiler_running, false);
+    pthread_join(sampler_thread, NULL);
+    INFO_LOG("Profiler stopped");
+}
+
+int korra_profiler_dump(FILE* out) {
+    if (!out) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&bucket_mutex);
+    int written = 0;
+
+    for (int i = 0; i < num_buckets; i++) {
+        stack_bucket_t* bucket = &buckets[i];
+        char** symbols = backtrace_symbols(bucket->frames, bucket->frame_count);
+
+        fprintf(out, "%s", bucket->name);
+        // Outermost frame first, per folded flame-graph convention;
+        // skip the innermost two (signal handler and trampoline)
+        for (int f = bucket->frame_count - 1; f >= 2; f--) {
+            fprintf(out, ";%s", symbols ? symbols[f] : "?");
+        }
+        fprintf(out, " %llu\n", (unsigned long long)bucket->count);
+
+        free(symbols);
+        written++;
+    }
+
+    if (overflow_samples > 0) {
+        fprintf(out, "overflow %llu\n", (unsigned long long)overflow_samples);
+    }
+
+    num_buckets = 0;
+    overflow_samples = 0;
+    pthread_mutex_unlock(&bucket_mutex);
+
+    return written;
+}